@@ -0,0 +1,88 @@
+/** @file Asignadores.cc
+    @brief Implementación de las clases Region y Pool
+*/
+
+#include "Asignadores.hh"
+
+/** @brief Tamaño del primer bloque de una región, en bytes */
+static const size_t PRIMER_BLOQUE = 256;
+/** @brief Tamaño máximo de un bloque de una región, en bytes (salvo que una sola reserva necesite más) */
+static const size_t MAX_BLOQUE = 16384;
+/** @brief Número de casillas que se piden de golpe cuando un pool se queda sin casillas libres */
+static const int CASILLAS_TROZO = 64;
+
+                                            //Constructora y destructora
+Region::Region()
+{
+    ultimo = NULL;
+    libre = fin = NULL;
+    siguiente = PRIMER_BLOQUE;
+}
+
+Region::~Region()
+{
+    while (ultimo != NULL) {
+        Bloque* b = ultimo;
+        ultimo = b->anterior;
+        ::operator delete(b);
+    }
+}
+
+                                            //Modificadoras
+void* Region::reservar_en_bloque_nuevo(size_t n, size_t alineacion)
+//el bloque empieza con su cabecera, y detras va el espacio para las reservas
+{
+    size_t mida = siguiente;
+    if (mida < sizeof(Bloque) + alineacion + n) mida = sizeof(Bloque) + alineacion + n;
+    if (siguiente < MAX_BLOQUE) siguiente *= 2;
+    Bloque* b = (Bloque*)::operator new(mida);
+    b->anterior = ultimo;
+    ultimo = b;
+    libre = (char*)b + sizeof(Bloque);
+    fin = (char*)b + mida;
+    return reservar(n, alineacion);
+}
+
+void Region::vaciar()
+{
+    if (ultimo == NULL) return;
+    while (ultimo->anterior != NULL) {
+        Bloque* b = ultimo->anterior;
+        ultimo->anterior = b->anterior;
+        ::operator delete(b);
+    }
+    libre = (char*)ultimo + sizeof(Bloque);
+}
+
+                                            //Pool
+Pool::Pool()
+{
+    libres = NULL;
+    ultimo = NULL;
+    mida = 0;
+}
+
+Pool::~Pool()
+{
+    while (ultimo != NULL) {
+        Trozo* t = ultimo;
+        ultimo = t->anterior;
+        ::operator delete(t);
+    }
+}
+
+void Pool::rellenar(size_t n, size_t alineacion)
+//el trozo empieza con su cabecera (ocupando lo mismo que max_align_t, para que las casillas queden alineadas), y detras van las casillas
+{
+    if (mida == 0) {
+        mida = n < sizeof(Casilla) ? sizeof(Casilla) : n;
+        if (alineacion < alignof(Casilla)) alineacion = alignof(Casilla);
+        mida = (mida + alineacion - 1) & ~(alineacion - 1);
+    }
+    size_t cabecera = (sizeof(Trozo) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+    Trozo* t = (Trozo*)::operator new(cabecera + CASILLAS_TROZO*mida);
+    t->anterior = ultimo;
+    ultimo = t;
+    char* casillas = (char*)t + cabecera;
+    for (int i = CASILLAS_TROZO - 1; i >= 0; --i) liberar(casillas + i*mida);
+}
@@ -0,0 +1,284 @@
+/** @file Asignadores.hh
+    @brief Especificación de las clases Region, Asignador_region, Pool, Asignador_pool y Asignador_linea
+*/
+
+#ifndef _ASIGNADORES_HH_
+#define _ASIGNADORES_HH_
+
+#ifndef NO_DIAGRAM
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+using namespace std;
+#endif
+
+/** @class Region
+    @brief Representa una región de memoria de la que se reservan trozos consecutivos y que se libera entera de golpe.
+
+    La memoria se pide al sistema en bloques, cada uno el doble de grande que el anterior (hasta un máximo), y cada reserva avanza un puntero dentro del último bloque. Los trozos no se liberan uno a uno: toda la región se libera al destruirla, con una operación por bloque. Así, los datos que se reservan juntos quedan juntos en memoria, y destruir la región cuesta un número de operaciones logarítmico en lo que ocupa y no lineal en el número de trozos.
+
+    Las operaciones son: reservar un trozo de memoria, vaciar la región para volver a usarla y (al destruir la región) liberarla toda.
+*/
+
+class Region
+{
+private:
+    /** @brief Cabecera de cada bloque: los bloques forman una lista, del último al primero */
+    struct Bloque {
+        Bloque* anterior;
+    };
+
+    /** @brief Último bloque pedido (NULL si todavía no se ha pedido ninguno) */
+    Bloque* ultimo;
+    /** @brief Primer byte libre del último bloque */
+    char* libre;
+    /** @brief Final del último bloque */
+    char* fin;
+    /** @brief Tamaño del próximo bloque que se pida */
+    size_t siguiente;
+
+public:
+    //Constructora y destructora
+    /** @brief Creadora por defecto
+        \pre <em>cierto</em>
+        \post El resultado es una región vacía (no pide memoria hasta la primera reserva)
+        \coste Constante
+    */
+    Region();
+
+    /** @brief Destructora
+        \pre Ya no se usa ningún trozo reservado de la región
+        \post Se ha liberado toda la memoria de la región
+        \coste Lineal en el número de bloques
+    */
+    ~Region();
+
+    //Modificadoras
+    /** @brief Reserva un trozo de memoria
+        \pre alineacion es una potencia de 2
+        \post Retorna un trozo de n bytes, alineado a "alineacion", que es válido hasta que se destruya la región
+        \coste Constante
+    */
+    void* reservar(size_t n, size_t alineacion)
+    {
+        char* p = (char*)(((size_t)libre + alineacion - 1) & ~(alineacion - 1));
+        if (p + n > fin) return reservar_en_bloque_nuevo(n, alineacion);
+        libre = p + n;
+        return p;
+    }
+
+    /** @brief Vacía la región conservando su último bloque (el más grande)
+        \pre Ya no se usa ningún trozo reservado de la región
+        \post Se han liberado todos los bloques menos el último, que vuelve a estar entero disponible para las próximas reservas
+        \coste Lineal en el número de bloques
+    */
+    void vaciar();
+
+private:
+    /** @brief Pide un bloque nuevo y reserva en él un trozo de memoria
+        \pre alineacion es una potencia de 2
+        \post Retorna un trozo de n bytes, alineado a "alineacion", del bloque nuevo, que pasa a ser el último
+        \coste Constante
+    */
+    void* reservar_en_bloque_nuevo(size_t n, size_t alineacion);
+
+    /** @brief Las regiones no se pueden copiar */
+    Region(const Region&);
+    Region& operator=(const Region&);
+};
+
+/** @class Asignador_region
+    @brief Asignador (para los contenedores de la biblioteca estándar) que reserva la memoria de una Region.
+
+    Liberar no hace nada: la memoria se recupera toda a la vez cuando se destruye la región. Es adecuado para contenedores que casi solo crecen, y cuya región se destruye junto con ellos. El asignador viaja con los elementos al mover o intercambiar el contenedor, pero no al asignarle una copia (la copia se reserva en la región del destino).
+*/
+template <class T> class Asignador_region
+{
+public:
+    typedef T value_type;
+    typedef false_type propagate_on_container_copy_assignment;
+    typedef true_type propagate_on_container_move_assignment;
+    typedef true_type propagate_on_container_swap;
+
+    /** @brief Región de la que se reserva la memoria */
+    Region* region;
+
+    /** @brief Creadora: el asignador reserva la memoria de r */
+    explicit Asignador_region(Region* r) : region(r) {}
+
+    /** @brief Creadora a partir de un asignador de otro tipo (reserva de la misma región) */
+    template <class U> Asignador_region(const Asignador_region<U>& a) : region(a.region) {}
+
+    /** @brief Reserva espacio para n objetos de tipo T */
+    T* allocate(size_t n) { return (T*)region->reservar(n*sizeof(T), alignof(T)); }
+
+    /** @brief No hace nada: la memoria se libera con la región */
+    void deallocate(T*, size_t) {}
+};
+
+/** @brief Dos asignadores de región son iguales si reservan de la misma región */
+template <class T, class U> bool operator==(const Asignador_region<T>& a, const Asignador_region<U>& b) { return a.region == b.region; }
+template <class T, class U> bool operator!=(const Asignador_region<T>& a, const Asignador_region<U>& b) { return a.region != b.region; }
+
+/** @class Pool
+    @brief Representa un pool de casillas de memoria de tamaño fijo, que se reservan y liberan de una en una.
+
+    Las casillas liberadas se guardan en una lista y se reaprovechan en la siguiente reserva, y cuando no queda ninguna se pide un trozo de casillas de golpe (contiguas, de manera que las casillas reservadas seguidas quedan cerca en memoria). Los trozos no se devuelven al sistema hasta que se destruye el pool. El tamaño de las casillas es el de la primera reserva.
+
+    El pool no tiene ningún cerrojo: cada pool pertenece a un solo contenedor (ver Asignador_pool), así que basta con que el contenedor se modifique desde un solo hilo a la vez, que ya es lo que exige cualquier contenedor de la biblioteca estándar.
+
+    Las operaciones son: reservar una casilla, liberarla y (al destruir el pool) liberar todos los trozos.
+*/
+
+class Pool
+{
+private:
+    /** @brief Casilla libre: apunta a la siguiente casilla libre */
+    struct Casilla {
+        Casilla* siguiente;
+    };
+
+    /** @brief Cabecera de cada trozo: los trozos forman una lista, del último al primero */
+    struct Trozo {
+        Trozo* anterior;
+    };
+
+    /** @brief Primera casilla libre (NULL si no hay ninguna) */
+    Casilla* libres;
+    /** @brief Último trozo pedido (NULL si todavía no se ha pedido ninguno) */
+    Trozo* ultimo;
+    /** @brief Tamaño de cada casilla, en bytes (0 si todavía no se ha hecho ninguna reserva) */
+    size_t mida;
+
+public:
+    //Constructora y destructora
+    /** @brief Creadora por defecto
+        \pre <em>cierto</em>
+        \post El resultado es un pool vacío (no pide memoria hasta la primera reserva)
+        \coste Constante
+    */
+    Pool();
+
+    /** @brief Destructora
+        \pre Ya no se usa ninguna casilla del pool
+        \post Se ha liberado toda la memoria del pool
+        \coste Lineal en el número de trozos
+    */
+    ~Pool();
+
+    //Modificadoras
+    /** @brief Reserva una casilla
+        \pre n es el mismo en todas las reservas del pool, y alineacion es una potencia de 2 no mayor que la de max_align_t
+        \post Retorna una casilla de n bytes, alineada a "alineacion", que es válida hasta que se libere o se destruya el pool
+        \coste Constante (amortizado)
+    */
+    void* reservar(size_t n, size_t alineacion)
+    {
+        if (libres == NULL) rellenar(n, alineacion);
+        Casilla* c = libres;
+        libres = c->siguiente;
+        return c;
+    }
+
+    /** @brief Libera una casilla
+        \pre p es una casilla reservada del pool que ya no se usa
+        \post La casilla vuelve a estar libre, y la próxima reserva la reaprovecha
+        \coste Constante
+    */
+    void liberar(void* p)
+    {
+        Casilla* c = (Casilla*)p;
+        c->siguiente = libres;
+        libres = c;
+    }
+
+private:
+    /** @brief Pide un trozo de casillas nuevas
+        \pre La misma que reservar
+        \post Se han añadido a la lista de libres las casillas de un trozo nuevo, que pasa a ser el último
+    */
+    void rellenar(size_t n, size_t alineacion);
+
+    /** @brief Los pools no se pueden copiar */
+    Pool(const Pool&);
+    Pool& operator=(const Pool&);
+};
+
+/** @class Asignador_pool
+    @brief Asignador (para los contenedores de la biblioteca estándar) que reserva los objetos de uno en uno de un Pool.
+
+    Es adecuado para los nodos de los contenedores basados en nodos (como map), que siempre reservan y liberan de uno en uno: cada contenedor tiene su propio pool, cuyas casillas son del tamaño de sus nodos. Las reservas de más de un objeto se piden directamente al sistema. Igual que Asignador_region, el asignador viaja con los elementos al mover o intercambiar el contenedor, pero no al asignarle una copia.
+*/
+template <class T> class Asignador_pool
+{
+public:
+    typedef T value_type;
+    typedef false_type propagate_on_container_copy_assignment;
+    typedef true_type propagate_on_container_move_assignment;
+    typedef true_type propagate_on_container_swap;
+
+    /** @brief Pool del que se reservan los objetos */
+    Pool* pool;
+
+    /** @brief Creadora: el asignador reserva los objetos de p */
+    explicit Asignador_pool(Pool* p) : pool(p) {}
+
+    /** @brief Creadora a partir de un asignador de otro tipo (reserva del mismo pool) */
+    template <class U> Asignador_pool(const Asignador_pool<U>& a) : pool(a.pool) {}
+
+    /** @brief Reserva espacio para n objetos de tipo T (si n es 1, del pool) */
+    T* allocate(size_t n)
+    {
+        if (n != 1) return (T*)::operator new(n*sizeof(T));
+        return (T*)pool->reservar(sizeof(T), alignof(T));
+    }
+
+    /** @brief Libera el espacio de n objetos de tipo T (si n es 1, la casilla vuelve al pool) */
+    void deallocate(T* p, size_t n)
+    {
+        if (n != 1) ::operator delete(p);
+        else pool->liberar(p);
+    }
+};
+
+/** @brief Dos asignadores de pool son iguales si reservan del mismo pool */
+template <class T, class U> bool operator==(const Asignador_pool<T>& a, const Asignador_pool<U>& b) { return a.pool == b.pool; }
+template <class T, class U> bool operator!=(const Asignador_pool<T>& a, const Asignador_pool<U>& b) { return a.pool != b.pool; }
+
+/** @brief Tamaño de una línea de caché, en bytes */
+const size_t LINEA_CACHE = 64;
+
+/** @class Asignador_linea
+    @brief Asignador (para los contenedores de la biblioteca estándar) que reserva la memoria en líneas de caché enteras: empieza al principio de una línea y ocupa un número entero de líneas.
+
+    Así, los elementos de un contenedor no comparten ninguna línea de caché con memoria reservada por otros, y dos hilos que escriben cada uno en su contenedor nunca se disputan una línea (falso compartimiento). Es adecuado para los contenedores que se modifican mucho desde un hilo mientras otros hilos hacen lo mismo con los suyos.
+*/
+template <class T> class Asignador_linea
+{
+public:
+    typedef T value_type;
+
+    /** @brief Creadora por defecto (el asignador no tiene estado) */
+    Asignador_linea() {}
+
+    /** @brief Creadora a partir de un asignador de otro tipo */
+    template <class U> Asignador_linea(const Asignador_linea<U>&) {}
+
+    /** @brief Reserva espacio para n objetos de tipo T, redondeado hacia arriba a líneas enteras */
+    T* allocate(size_t n)
+    {
+        void* p;
+        size_t mida = (n*sizeof(T) + LINEA_CACHE - 1) & ~(LINEA_CACHE - 1);
+        if (posix_memalign(&p, LINEA_CACHE, mida) != 0) throw bad_alloc();
+        return (T*)p;
+    }
+
+    /** @brief Libera el espacio de n objetos de tipo T */
+    void deallocate(T* p, size_t) { free(p); }
+};
+
+/** @brief Todos los asignadores de línea son iguales (la memoria de uno se puede liberar con otro) */
+template <class T, class U> bool operator==(const Asignador_linea<T>&, const Asignador_linea<U>&) { return true; }
+template <class T, class U> bool operator!=(const Asignador_linea<T>&, const Asignador_linea<U>&) { return false; }
+#endif
@@ -0,0 +1,171 @@
+/** @file Binario.cc
+    @brief Implementación de las clases Escritor_binario, Lector_binario y Fichero_proyectado
+*/
+#include "Binario.hh"
+
+#ifndef NO_DIAGRAM
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+unsigned int suma_comprobacion(const char* datos, size_t n, unsigned int h)
+{
+    for (size_t i = 0; i < n; ++i) h = (h ^ (unsigned char)datos[i]) * 16777619u;
+    return h;
+}
+
+bool sincronizar_directorio(const string& nombre)
+{
+    size_t barra = nombre.rfind('/');
+    string directorio = barra == string::npos ? "." : barra == 0 ? "/" : nombre.substr(0, barra);
+    int fd = open(directorio.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd == -1) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+                                                    //Escritor_binario
+Escritor_binario::Escritor_binario(FILE* f)
+{
+    this->f = f;
+    error = false;
+    suma = suma_comprobacion(NULL, 0);
+}
+
+bool Escritor_binario::fallo() const
+{
+    return error;
+}
+
+unsigned int Escritor_binario::consultar_suma() const
+{
+    return suma;
+}
+
+void Escritor_binario::escribir_bytes(const void* p, int n)
+{
+    if (n <= 0) return;
+    if (fwrite(p, 1, n, f) != size_t(n)) error = true;
+    suma = suma_comprobacion((const char*)p, n, suma);
+}
+
+void Escritor_binario::escribir_entero(int x)
+{
+    escribir_bytes(&x, sizeof(x));
+}
+
+void Escritor_binario::escribir_entero_largo(long long x)
+{
+    escribir_bytes(&x, sizeof(x));
+}
+
+void Escritor_binario::escribir_string(const string& s)
+{
+    escribir_entero(s.size());
+    escribir_bytes(s.data(), s.size());
+}
+
+                                                    //Lector_binario
+Lector_binario::Lector_binario(const char* datos, size_t mida)
+{
+    ini = datos;
+    fin = datos + mida;
+    error = false;
+}
+
+bool Lector_binario::fallo() const
+{
+    return error;
+}
+
+void Lector_binario::leer_bytes(void* p, int n)
+{
+    if (error or n < 0 or fin - ini < n) {
+        error = true;
+        memset(p, 0, n > 0 ? n : 0);
+    }
+    else {
+        memcpy(p, ini, n);
+        ini += n;
+    }
+}
+
+int Lector_binario::leer_entero()
+{
+    int x;
+    leer_bytes(&x, sizeof(x));
+    return x;
+}
+
+long long Lector_binario::leer_entero_largo()
+{
+    long long x;
+    leer_bytes(&x, sizeof(x));
+    return x;
+}
+
+string Lector_binario::leer_string()
+{
+    int n = leer_entero();
+    if (error or n < 0 or fin - ini < n) {
+        error = true;
+        return string();
+    }
+    string s(ini, n);
+    ini += n;
+    return s;
+}
+
+int Lector_binario::leer_cantidad(int mida)
+{
+    int n = leer_entero();
+    if (error or n < 0 or (fin - ini)/mida < n) {
+        error = true;
+        return 0;
+    }
+    return n;
+}
+
+                                                    //Fichero_proyectado
+Fichero_proyectado::Fichero_proyectado()
+{
+    datos = NULL;
+    mida = 0;
+}
+
+Fichero_proyectado::~Fichero_proyectado()
+{
+    if (datos != NULL) munmap(datos, mida);
+}
+
+bool Fichero_proyectado::abrir(const string& nombre)
+{
+    int fd = open(nombre.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 and st.st_size > 0;
+    if (ok) {
+        void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ok = p != MAP_FAILED;
+        if (ok) {
+            datos = (char*)p;
+            mida = st.st_size;
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+const char* Fichero_proyectado::consultar_datos() const
+{
+    return datos;
+}
+
+size_t Fichero_proyectado::consultar_mida() const
+{
+    return mida;
+}
@@ -0,0 +1,168 @@
+/** @file Binario.hh
+    @brief Especificación de las clases Escritor_binario, Lector_binario y Fichero_proyectado
+*/
+
+#ifndef _BINARIO_HH_
+#define _BINARIO_HH_
+
+#ifndef NO_DIAGRAM
+#include <cstdio>
+#include <string>
+using namespace std;
+#endif
+
+/** @brief Versión del formato binario del estado de la plataforma. Hay que incrementarla cada vez que cambie lo que guarda alguna clase */
+const int VERSION_ESTADO = 7;
+
+/** @brief Suma de comprobación (FNV-1a) de n bytes
+    \pre datos apunta a n bytes
+    \post Retorna la suma de comprobación de los n bytes, partiendo del valor h (para continuar una suma anterior)
+*/
+unsigned int suma_comprobacion(const char* datos, size_t n, unsigned int h = 2166136261u);
+
+/** @brief Sincroniza con el disco el directorio de un fichero
+    \pre <em>cierto</em>
+    \post Retorna true si se ha podido sincronizar (fsync) el directorio que contiene el fichero "nombre", de manera que los cambios de nombre hechos en él ya no se pierden aunque el sistema se interrumpa
+*/
+bool sincronizar_directorio(const string& nombre);
+
+/** @class Escritor_binario
+    @brief Representa un fichero en el que se escribe el estado de la plataforma en formato binario.
+
+    Los enteros se escriben con 4 bytes (en el orden de bytes de la máquina) y los strings como su longitud seguida de sus caracteres. El escritor acumula la suma de comprobación de todo lo que ha escrito.
+*/
+
+class Escritor_binario
+{
+private:
+    /** @brief Fichero en el que se escribe */
+    FILE* f;
+    /** @brief Indica si alguna escritura ha fallado */
+    bool error;
+    /** @brief Suma de comprobación de los bytes escritos hasta ahora */
+    unsigned int suma;
+
+public:
+    /** @brief Creadora a partir de un fichero abierto
+        \pre f es un fichero abierto para escritura binaria
+        \post Se ha creado un escritor binario sobre f
+        \coste Constante
+    */
+    explicit Escritor_binario(FILE* f);
+
+    /** @brief Consulta si alguna escritura ha fallado
+        \pre <em>cierto</em>
+        \post Retorna true si alguna de las escrituras hechas hasta ahora ha fallado
+        \coste Constante
+    */
+    bool fallo() const;
+
+    /** @brief Consulta la suma de comprobación de lo escrito
+        \pre <em>cierto</em>
+        \post Retorna la suma de comprobación (ver suma_comprobacion) de todos los bytes escritos hasta ahora
+        \coste Constante
+    */
+    unsigned int consultar_suma() const;
+
+    /** @brief Escritura de n bytes */
+    void escribir_bytes(const void* p, int n);
+    /** @brief Escritura de un entero */
+    void escribir_entero(int x);
+    /** @brief Escritura de un entero largo (8 bytes) */
+    void escribir_entero_largo(long long x);
+    /** @brief Escritura de un string */
+    void escribir_string(const string& s);
+};
+
+/** @class Lector_binario
+    @brief Representa una zona de memoria (normalmente un fichero proyectado) de la que se lee el estado de la plataforma en formato binario.
+
+    Lee el formato que escribe Escritor_binario. Si se intenta leer más allá del final de la zona, la lectura falla y retorna ceros.
+*/
+
+class Lector_binario
+{
+private:
+    /** @brief Siguiente byte por leer */
+    const char* ini;
+    /** @brief Byte que sigue al último de la zona */
+    const char* fin;
+    /** @brief Indica si alguna lectura ha fallado */
+    bool error;
+
+public:
+    /** @brief Creadora a partir de una zona de memoria
+        \pre datos apunta a mida bytes
+        \post Se ha creado un lector binario sobre la zona
+        \coste Constante
+    */
+    Lector_binario(const char* datos, size_t mida);
+
+    /** @brief Consulta si alguna lectura ha fallado
+        \pre <em>cierto</em>
+        \post Retorna true si alguna de las lecturas hechas hasta ahora ha ido más allá del final de la zona
+        \coste Constante
+    */
+    bool fallo() const;
+
+    /** @brief Lectura de n bytes */
+    void leer_bytes(void* p, int n);
+    /** @brief Lectura de un entero */
+    int leer_entero();
+    /** @brief Lectura de un entero largo (8 bytes) */
+    long long leer_entero_largo();
+    /** @brief Lectura de un string */
+    string leer_string();
+
+    /** @brief Lectura de un número de elementos
+        \pre mida > 0
+        \post Lee un entero n, que es el número de elementos que le siguen en la zona, cada uno de como mínimo "mida" bytes. Si n es negativo o no caben n elementos en lo que queda de la zona (el fichero está corrupto o cortado), la lectura falla y retorna 0. Así, nunca se reserva memoria para más elementos de los que puede contener el fichero
+        \coste Constante
+    */
+    int leer_cantidad(int mida);
+};
+
+/** @class Fichero_proyectado
+    @brief Representa un fichero proyectado en memoria (mmap) en modo de solo lectura.
+
+    La proyección se deshace al destruir el objeto.
+*/
+
+class Fichero_proyectado
+{
+private:
+    /** @brief Inicio de la proyección (NULL si no hay ningún fichero proyectado) */
+    char* datos;
+    /** @brief Tamaño del fichero */
+    size_t mida;
+
+public:
+    /** @brief Creadora por defecto
+        \pre <em>cierto</em>
+        \post Se ha creado un objeto sin ningún fichero proyectado
+    */
+    Fichero_proyectado();
+
+    /** @brief Destructora
+        \pre <em>cierto</em>
+        \post Se ha deshecho la proyección (si la había)
+    */
+    ~Fichero_proyectado();
+
+    /** @brief Proyecta un fichero en memoria
+        \pre no hay ningún fichero proyectado en el parámetro implícito
+        \post Retorna true si se ha podido proyectar el fichero "nombre". En tal caso, el contenido del fichero está disponible mediante consultar_datos() y consultar_mida()
+    */
+    bool abrir(const string& nombre);
+
+    /** @brief Consulta el inicio de la proyección */
+    const char* consultar_datos() const;
+    /** @brief Consulta el tamaño del fichero proyectado */
+    size_t consultar_mida() const;
+
+private:
+    /** @brief Los objetos no se pueden copiar (la proyección solo se puede deshacer una vez) */
+    Fichero_proyectado(const Fichero_proyectado&);
+    Fichero_proyectado& operator=(const Fichero_proyectado&);
+};
+#endif
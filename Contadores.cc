@@ -0,0 +1,55 @@
+/** @file Contadores.cc
+    @brief Implementación de la clase Contadores_envios
+*/
+#include "Contadores.hh"
+
+                                                    //Constructora
+Contadores_envios::Contadores_envios() {}
+                                                    //Consultoras
+bool Contadores_envios::vacio() const
+{
+    return problemas_tocados.empty() and cursos_tocados.empty() and envios_cursos.empty();
+}
+                                                    //Modificadoras
+void Contadores_envios::anotar_envio(int p, bool r)
+//los vectores crecen a medida que aparecen indices mas grandes (la plataforma puede tener problemas nuevos desde la ultima vez)
+{
+    if (p >= totales.size()) {
+        totales.resize(p + 1, 0);
+        correctos.resize(p + 1, 0);
+    }
+    if (totales[p] == 0) problemas_tocados.push_back(p);
+    ++totales[p];
+    if (r) ++correctos[p];
+}
+
+void Contadores_envios::anotar_curso_completado(int c)
+{
+    if (c >= completados.size()) completados.resize(c + 1, 0);
+    if (completados[c] == 0) cursos_tocados.push_back(c);
+    ++completados[c];
+}
+
+void Contadores_envios::anotar_envio_curso(const Curso::Envio& e)
+{
+    envios_cursos.push_back(e);
+}
+
+void Contadores_envios::aplicar(Plataforma_material& pm)
+//solo se recorren (y se vuelven a poner a 0) las posiciones tocadas; cada problema se mueve una sola vez en el indice por ratio
+{
+    for (int i = 0; i < problemas_tocados.size(); ++i) {
+        int p = problemas_tocados[i];
+        pm.sumar_envios_problema(p, totales[p], correctos[p]);
+        totales[p] = correctos[p] = 0;
+    }
+    for (int i = 0; i < cursos_tocados.size(); ++i) {
+        int c = cursos_tocados[i];
+        for (int k = 0; k < completados[c]; ++k) pm.restar_inscritos(c, true);
+        completados[c] = 0;
+    }
+    for (int i = 0; i < envios_cursos.size(); ++i) pm.anotar_envio_curso(envios_cursos[i]);
+    problemas_tocados.clear();
+    cursos_tocados.clear();
+    envios_cursos.clear();
+}
@@ -0,0 +1,93 @@
+/** @file Contadores.hh
+    @brief Especificación de la clase Contadores_envios
+*/
+
+#ifndef _CONTADORES_HH_
+#define _CONTADORES_HH_
+
+#include "Plataforma_material.hh"
+#include "Asignadores.hh"
+
+#ifndef NO_DIAGRAM
+#include <vector>
+using namespace std;
+#endif
+
+/** @class Contadores_envios
+    @brief Representa los cambios que un hilo ha ido acumulando para la plataforma de material mientras hacía envíos: envíos (totales y correctos) a cada problema, envíos a cada problema dentro de su curso y usuarios que han completado cada curso.
+
+    Cada hilo que hace envíos en paralelo tiene sus propios contadores, así que ningún contador se comparte y los problemas más populares no hacen ir las líneas de caché de un procesador a otro. Los contadores son vectores densos (por índice de problema y de curso). Para que dos hilos nunca escriban en la misma línea, la memoria de los vectores se reserva en líneas de caché enteras (ver Asignador_linea), y el objeto acaba con una línea de relleno, de manera que los atributos de dos objetos consecutivos (que cambian con cada push_back) tampoco comparten línea. Los problemas y cursos tocados se apuntan en una lista, así que aplicar los contadores a la plataforma cuesta tiempo lineal en lo que se ha tocado, no en el tamaño de la plataforma.
+
+    Los contadores no se aplican a la plataforma después de cada envío, sino cuando hace falta consultarla (ver program.cc).
+
+    Las operaciones son: consultar si hay cambios pendientes, anotar un envío, anotar un envío dentro de un curso, anotar un curso completado y aplicar los cambios a la plataforma de material.
+*/
+
+class Contadores_envios
+{
+private:
+    /** @brief Vector de enteros cuya memoria ocupa líneas de caché enteras */
+    typedef vector<int, Asignador_linea<int> > Vector_linea;
+
+    /** @brief Envíos totales pendientes de cada problema, por índice de problema */
+    Vector_linea totales;
+    /** @brief Envíos correctos pendientes de cada problema, por índice de problema */
+    Vector_linea correctos;
+    /** @brief Índices de los problemas con envíos pendientes (cada uno una sola vez) */
+    Vector_linea problemas_tocados;
+    /** @brief Usuarios que han completado cada curso, por identificador de curso */
+    Vector_linea completados;
+    /** @brief Identificadores de los cursos con completados pendientes (cada uno una sola vez) */
+    Vector_linea cursos_tocados;
+    /** @brief Envíos pendientes de anotar en los contadores de los problemas de cada curso, en el orden en que se hicieron */
+    vector<Curso::Envio, Asignador_linea<Curso::Envio> > envios_cursos;
+    /** @brief Relleno para que los atributos de dos objetos consecutivos (por ejemplo, en un vector de contadores, uno por hilo) no compartan línea de caché */
+    char relleno[LINEA_CACHE];
+
+public:
+    //Constructora
+    /** @brief Creadora por defecto
+        \pre <em>cierto</em>
+        \post Se han creado unos contadores sin cambios pendientes
+        \coste Constante
+    */
+    Contadores_envios();
+
+    //Consultoras
+    /** @brief Consulta si hay cambios pendientes
+        \pre <em>cierto</em>
+        \post Retorna true si no se ha anotado nada desde la última vez que se aplicaron los contadores
+        \coste Constante
+    */
+    bool vacio() const;
+
+    //Modificadoras
+    /** @brief Anota un envío a un problema
+        \pre p es el índice de un problema de la plataforma, r indica si el envío es correcto
+        \post Se ha sumado uno a los envíos totales pendientes de p y, si r, a los correctos
+        \coste Constante (amortizado)
+    */
+    void anotar_envio(int p, bool r);
+
+    /** @brief Anota que un usuario ha completado un curso
+        \pre c es el identificador de un curso de la plataforma
+        \post Se ha sumado uno a los completados pendientes de c
+        \coste Constante (amortizado)
+    */
+    void anotar_curso_completado(int c);
+
+    /** @brief Anota un envío a un problema de un curso
+        \pre e es un envío hecho por un usuario inscrito en el curso e.curso
+        \post El envío queda pendiente de anotar en los contadores del curso
+        \coste Constante (amortizado)
+    */
+    void anotar_envio_curso(const Curso::Envio& e);
+
+    /** @brief Aplica los cambios pendientes a la plataforma de material
+        \pre Los cambios se han anotado a partir de envíos hechos sobre pm
+        \post pm queda igual que si los envíos se hubieran hecho uno a uno, y no quedan cambios pendientes (los vectores conservan su tamaño para la próxima vez)
+        \coste Lineal en el número de problemas y cursos tocados por log P, más lineal en el número de envíos anotados dentro de cursos
+    */
+    void aplicar(Plataforma_material& pm);
+};
+#endif
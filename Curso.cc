@@ -8,18 +8,46 @@ Curso::Curso(int num_sesiones)
 {
   num_completado = 0;
   num_usuarios_inscritos = 0;
-  sesiones = vector<string> (num_sesiones);
+  sesiones = vector<int> (num_sesiones);
+  bases = vector<int> (num_sesiones);
 }
                                                     //Consultoras
 
-string Curso::encontrar_sesion_problema(string p) const
+int Curso::encontrar_sesion_problema(int p) const
 {
-    map<string, string>::const_iterator it = problemas.find(p); //busca en el map de "curso" donde tenemos guardados todos los problemas (es un map pequeñito)
-    if (it != problemas.end()) return it->second;
-    return "0"; //aprovechamos el hecho que, por como se leen las sesiones, sabemos que no es posible que un problema tenga el identificador "0"
+    const Ubicacion* ub = problemas.consultar(p); //busca en el map de "curso" donde tenemos guardados todos los problemas (es un map pequeñito)
+    if (ub != NULL) return ub->sesion;
+    return -1;
 }
 
-string Curso::consultar_sesion_i(int i) const
+Curso::Ubicacion Curso::ubicar_problema(int p) const
+{
+    return *problemas.consultar(p);
+}
+
+int Curso::consultar_local(int p) const
+{
+    const Ubicacion* ub = problemas.consultar(p);
+    if (ub != NULL) return ub->local;
+    return -1;
+}
+
+int Curso::consultar_problema_local(int j) const
+{
+    return locales[j];
+}
+
+int Curso::consultar_num_problemas_curso() const
+{
+    return locales.size();
+}
+
+int Curso::consultar_base_sesion_i(int i) const
+{
+    return bases[i-1];
+}
+
+int Curso::consultar_sesion_i(int i) const
 {
   return sesiones[i-1];
 }
@@ -29,13 +57,47 @@ int Curso::consultar_num_sesiones_curso() const
   return sesiones.size();
 }
 
+const vector<unsigned long long>& Curso::consultar_enviables_iniciales() const
+{
+    return enviables_iniciales;
+}
+
                                                     //Modificadoras
-bool Curso::insertar_problema(string p, string s)
+void Curso::iniciar_sesion_i(int i)
+{
+    bases[i-1] = locales.size();
+}
+
+void Curso::insertar_problema(int p, int s, int nodo)
 //esta funcion solo se llama (desde Sesion) cuando se esta leyendo un curso nuevo, en particular cuando se lee la estructura de problemas de una sesion del curso
-//permite actualizar el curso anadiendole un problema (que proviene de la sesion), al mismo tiempo que permite detectar si el parametro implicito ya contenia dicho problema
+//permite actualizar el curso anadiendole un problema (que proviene de la sesion). Los repetidos no se buscan aqui, sino todos juntos al acabar (ver ordenar_problemas)
+//el indice local es el siguiente libre: como las sesiones se tratan por orden y los nodos en preorden, coincide con la base de la sesion mas la posicion del nodo
 {
-    pair<map<string,string>::iterator, bool> insertat = problemas.insert(make_pair(p,s));
-    return insertat.second;
+    Ubicacion ub;
+    ub.sesion = s;
+    ub.nodo = nodo;
+    ub.local = locales.size();
+    problemas.anadir_sin_ordenar(p, ub);
+    locales.push_back(p);
+    envios_problema.push_back(0);
+    correctos_problema.push_back(0);
+    intentadores_problema.push_back(0);
+}
+
+bool Curso::ordenar_problemas()
+{
+    return problemas.ordenar();
+}
+
+void Curso::calcular_enviables_iniciales()
+//la raiz de la sesion i es el primer problema de la sesion, cuyo indice local es su base; la sesion esta vacia si la siguiente empieza en la misma base
+{
+    int n = locales.size();
+    enviables_iniciales.assign((n + 63)/64, 0);
+    for (int i = 0; i < bases.size(); ++i) {
+        int fin = i + 1 < bases.size() ? bases[i + 1] : n;
+        if (bases[i] < fin) enviables_iniciales[bases[i] >> 6] |= 1ULL << (bases[i] & 63);
+    }
 }
 
 int Curso::modificar_stats(bool completado)
@@ -52,23 +114,134 @@ void Curso::desinscribir_usuario(bool completado)
     --num_usuarios_inscritos;
     if (completado) ++num_completado;
 }
+
+void Curso::anotar_envio(const Envio& e)
+{
+    ++envios_problema[e.local];
+    if (e.correcto) ++correctos_problema[e.local];
+    if (e.primer_intento) ++intentadores_problema[e.local];
+    Puesto antes;
+    antes.resueltos = e.resueltos - (e.correcto ? 1 : 0);
+    antes.envios = e.envios - 1;
+    antes.usuario = e.usuario;
+    clasificacion.erase(antes);
+    if (e.resueltos < locales.size()) { //si lo ha completado, ya no esta inscrito y no vuelve a la clasificacion
+        Puesto despues;
+        despues.resueltos = e.resueltos;
+        despues.envios = e.envios;
+        despues.usuario = e.usuario;
+        clasificacion.insert(despues);
+    }
+}
+
+void Curso::anadir_clasificacion(const string* u, int resueltos, int envios)
+{
+    Puesto p;
+    p.resueltos = resueltos;
+    p.envios = envios;
+    p.usuario = u;
+    clasificacion.insert(p);
+}
+
+void Curso::quitar_clasificacion(const string* u, int resueltos, int envios)
+{
+    Puesto p;
+    p.resueltos = resueltos;
+    p.envios = envios;
+    p.usuario = u;
+    clasificacion.erase(p);
+}
                                                     //Lectura y escritura
-void Curso::leer_sesiones_curso(int num_sesiones)
+void Curso::leer_sesiones_curso(int num_sesiones, const Tabla_ids& ids_sesiones)
 {
     for(int i = 0; i < num_sesiones; ++i) {
         string id;
-        cin >> id;
-        sesiones[i] = id;
+        entrada >> id;
+        sesiones[i] = ids_sesiones.consultar_indice(id);
     }
 }
 
-void Curso::escribir_curso() const
+void Curso::escribir_curso(const Tabla_ids& ids_sesiones) const
 {
-    cout << num_completado << " " << num_usuarios_inscritos << " " << sesiones.size() << " ";
+    salida << num_completado << " " << num_usuarios_inscritos << " " << sesiones.size() << " ";
     int size = sesiones.size();
     for (int i = 0; i < size; ++i) {
-        if (i == 0) cout << "(" << sesiones[i];
-        else cout << " " << sesiones[i];
+        if (i == 0) salida << "(" << ids_sesiones.consultar_id(sesiones[i]);
+        else salida << " " << ids_sesiones.consultar_id(sesiones[i]);
+    }
+    salida << ")" << '\n';
+}
+
+void Curso::escribir_estadisticas(const Tabla_ids& ids_problemas) const
+//los resolutores son los envios correctos: cada usuario solo puede acertar un problema una vez
+{
+    for (int j = 0; j < locales.size(); ++j) {
+        salida << ids_problemas.consultar_id(locales[j]) << "(" << envios_problema[j] << "," << correctos_problema[j] << ","
+               << intentadores_problema[j] << "," << correctos_problema[j] << ")" << '\n';
+    }
+}
+
+void Curso::escribir_clasificacion(int k) const
+{
+    set<Puesto, Mejor_puesto>::const_iterator it = clasificacion.begin();
+    for (int i = 0; i < k and it != clasificacion.end(); ++i, ++it) {
+        salida << *it->usuario << "(" << it->resueltos << "," << it->envios << ")" << '\n';
+    }
+}
+
+                                                    //Lectura y escritura en formato binario
+void Curso::guardar(Escritor_binario& f) const
+{
+    f.escribir_entero(num_usuarios_inscritos);
+    f.escribir_entero(num_completado);
+    f.escribir_entero(sesiones.size());
+    for (int i = 0; i < sesiones.size(); ++i) {
+        f.escribir_entero(sesiones[i]);
+        f.escribir_entero(bases[i]);
+    }
+    f.escribir_entero(locales.size());
+    for (int j = 0; j < locales.size(); ++j) { //por indice local, asi al cargar se reconstruye "locales" directamente
+        const Ubicacion& ub = *problemas.consultar(locales[j]);
+        f.escribir_entero(locales[j]);
+        f.escribir_entero(ub.sesion);
+        f.escribir_entero(ub.nodo);
+        f.escribir_entero(envios_problema[j]);
+        f.escribir_entero(correctos_problema[j]);
+        f.escribir_entero(intentadores_problema[j]);
+    }
+}
+
+void Curso::cargar(Lector_binario& f)
+{
+    num_usuarios_inscritos = f.leer_entero();
+    num_completado = f.leer_entero();
+    int n = f.leer_cantidad(2*sizeof(int));
+    sesiones.clear();
+    bases.clear();
+    for (int i = 0; i < n and not f.fallo(); ++i) {
+        sesiones.push_back(f.leer_entero());
+        bases.push_back(f.leer_entero());
+    }
+    n = f.leer_cantidad(6*sizeof(int));
+    problemas.clear();
+    problemas.reservar(n);
+    clasificacion.clear();
+    locales.clear();
+    envios_problema.clear();
+    correctos_problema.clear();
+    intentadores_problema.clear();
+    for (int j = 0; j < n and not f.fallo(); ++j) {
+        int p = f.leer_entero();
+        Ubicacion ub;
+        ub.sesion = f.leer_entero();
+        ub.nodo = f.leer_entero();
+        ub.local = j;
+        problemas.anadir_sin_ordenar(p, ub); //estan por indice local: se ordenan por problema al acabar
+        locales.push_back(p);
+        envios_problema.push_back(f.leer_entero());
+        correctos_problema.push_back(f.leer_entero());
+        intentadores_problema.push_back(f.leer_entero());
     }
-    cout << ")" << endl;
+    problemas.ordenar(); //el fichero lo ha escrito guardar (y se ha comprobado su suma), asi que no hay problemas repetidos
+    if (not f.fallo()) calcular_enviables_iniciales(); //si el fichero esta cortado, las bases pueden apuntar fuera de los problemas leidos
 }
@@ -8,26 +8,92 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <set>
+#include <string>
 using namespace std;
 #endif
 
+#include "Tabla_ids.hh"
+#include "Mapa_plano.hh"
+#include "Lector.hh"
+#include "Escritor.hh"
+
 /** @class Curso
     @brief Representa la información y las operaciones asociadas a un curso.
 
-    La información viene dada por: el conjunto de sesiones (ordenadas) que lo forman, el conjunto de problemas que lo forman (asociados cada uno con la sesión a que pertenecen), número de usuarios que lo han completado, y el número de usuarios inscritos actualmente.
+    La información viene dada por: el conjunto de sesiones (ordenadas) que lo forman, el conjunto de problemas que lo forman (asociados cada uno con la sesión a que pertenecen, con la posición de su nodo dentro del árbol de la sesión y con su índice local dentro del curso), número de usuarios que lo han completado, el número de usuarios inscritos actualmente y, para cada problema, cuántos envíos ha recibido dentro del curso, cuántos han sido correctos y cuántos usuarios lo han intentado. Además, el curso mantiene la clasificación de sus usuarios inscritos.
+
+    Los problemas del curso se numeran de 0 a n-1 (índice local) en el orden en que se añaden: sesión por sesión, y dentro de cada sesión en preorden. Así, los problemas de la sesión i ocupan un intervalo de índices locales que empieza en su base, y el índice local de un problema es la base de su sesión más la posición de su nodo. Esta numeración densa es la que utiliza Usuario para guardar su progreso en el curso.
+
+    Los contadores de cada problema se guardan en vectores por índice local, así que anotar un envío cuesta tiempo constante. Un usuario solo puede enviar un problema mientras no lo tiene resuelto, y no puede volver a enviarlo en otro curso una vez resuelto; por eso cada envío correcto es de un usuario distinto, y el número de usuarios que han resuelto el problema en el curso coincide con el de envíos correctos.
+
+    La clasificación es un conjunto ordenado de puestos (problemas resueltos en el curso, envíos hechos en el curso e identificador del usuario), del mejor al peor: más problemas resueltos primero, y a igualdad, menos envíos (y después, por identificador). Cada envío mueve el puesto de su usuario (una eliminación y una inserción, coste logarítmico), y consultar los k primeros solo recorre el principio del conjunto. Los identificadores no se copian: el puesto apunta al identificador que guarda la plataforma de usuarios, que tiene que quitar al usuario de la clasificación antes de borrarlo.
 
-    Las operaciones son: las consultoras de la sesión asociada a un problema, de la sesión que ocupa una cierta posición dada, y del número de sesiones del curso; las modificadoras de añadir un problema al conjunto de problemas del curso, de actualizar el número de inscritos y completados, y la de desinscribirle un usuario; la de lectura de las sesiones de un curso; y la de escritura de un curso.
+    Al inscribirse, casi todos los usuarios no tienen resuelto ningún problema del curso, y en ese caso sus enviables son siempre los mismos: la raíz del árbol de cada sesión. El curso los calcula una sola vez (al acabar de leerlo) y los guarda como conjunto de bits, de manera que inscribir a estos usuarios es copiar unas pocas palabras, independientemente del tamaño de los árboles.
+
+    Un curso tiene pocos problemas y, una vez leído, su conjunto de problemas solo se consulta (en cada envío y cada sesion_problema), así que se guarda en un Mapa_plano: las búsquedas recorren un vector contiguo de índices en lugar de una tabla de dispersión.
+
+    Las operaciones son: las consultoras de la sesión asociada a un problema, de la sesión que ocupa una cierta posición dada, y del número de sesiones del curso; las modificadoras de añadir un problema al conjunto de problemas del curso, de actualizar el número de inscritos y completados, la de desinscribirle un usuario, las de añadir y quitar un usuario de la clasificación y la de anotar un envío a uno de sus problemas; la de lectura de las sesiones de un curso; y las de escritura de un curso, de los contadores de sus problemas y de los primeros de la clasificación.
 
 */
 
 class Curso
 {
+public:
+    /** @brief Ubicación de un problema dentro del curso: índice de su sesión, posición de su nodo en el árbol de la sesión e índice local dentro del curso */
+    struct Ubicacion {
+        int sesion;
+        int nodo;
+        int local;
+    };
+
+    /** @brief Envío a un problema de un curso: identificador del curso, índice local del problema, si es correcto, si es el primer envío del usuario a ese problema, y el usuario que lo ha hecho con los problemas resueltos y los envíos que tiene en el curso después del envío */
+    struct Envio {
+        int curso;
+        int local;
+        bool correcto;
+        bool primer_intento;
+        const string* usuario;
+        int resueltos;
+        int envios;
+    };
+
+    /** @brief Puesto de un usuario en la clasificación del curso: problemas resueltos y envíos hechos en el curso, e identificador del usuario */
+    struct Puesto {
+        int resueltos;
+        int envios;
+        const string* usuario;
+    };
+
+    /** @brief Orden de la clasificación: más problemas resueltos, menos envíos y menor identificador */
+    struct Mejor_puesto {
+        bool operator()(const Puesto& a, const Puesto& b) const
+        {
+            if (a.resueltos != b.resueltos) return a.resueltos > b.resueltos;
+            if (a.envios != b.envios) return a.envios < b.envios;
+            return *a.usuario < *b.usuario;
+        }
+    };
 
 private:
-    /** @brief Estructura donde se guardan los identificadores de las sesiones que lo forman (en orden en que se leyeron) */
-    vector<string> sesiones;
-    /** @brief Estructura donde se guardan los problemas del curso (juntamente con el string de la sesión a la que pertenecen) */
-    map <string,string> problemas;
+    /** @brief Estructura donde se guardan los índices de las sesiones que lo forman (en orden en que se leyeron) */
+    vector<int> sesiones;
+    /** @brief Índice local del primer problema de cada sesión (en el mismo orden que "sesiones") */
+    vector<int> bases;
+    /** @brief Estructura donde se guardan los índices de los problemas del curso, juntamente con su ubicación */
+    Mapa_plano<int, Ubicacion> problemas;
+    /** @brief Índice (en la plataforma) de cada problema del curso, por índice local */
+    vector<int> locales;
+    /** @brief Bits (por índice local, en el mismo formato que Usuario) de los problemas enviables de un usuario que no tiene resuelto ningún problema del curso: las raíces de las sesiones */
+    vector<unsigned long long> enviables_iniciales;
+    /** @brief Envíos que ha recibido cada problema dentro del curso, por índice local */
+    vector<int> envios_problema;
+    /** @brief Envíos correctos que ha recibido cada problema dentro del curso (que es también el número de usuarios que lo han resuelto), por índice local */
+    vector<int> correctos_problema;
+    /** @brief Número de usuarios que han intentado cada problema dentro del curso, por índice local */
+    vector<int> intentadores_problema;
+    /** @brief Clasificación de los usuarios inscritos en el curso, del mejor al peor */
+    set<Puesto, Mejor_puesto> clasificacion;
     /** @brief Número de usuarios que actualmente están registrados en el curso */
     int num_usuarios_inscritos;
     /** @brief Número de usuarios que han completado el curso (actuales o pasados) */
@@ -45,18 +111,53 @@ public:
 
     //Consultoras
     /** @brief Consulta cuál es la sesión a la que pertenece un problema del parámetro implícito
-        \pre p es el identificador del problema que estamos buscando.
-        \post Retorna el identificador de la sesión a la que pertenece el problema p. Si p no pertenece al curso, retorna el string "0"
+        \pre p es el índice del problema que estamos buscando.
+        \post Retorna el índice de la sesión a la que pertenece el problema p. Si p no pertenece al curso, retorna -1
         \coste Logarítmico en el número de problemas del curso
     */
-    string encontrar_sesion_problema(string p) const;
+    int encontrar_sesion_problema(int p) const;
+
+    /** @brief Consulta dónde se encuentra un problema del parámetro implícito
+        \pre p es el índice de un problema del curso
+        \post Retorna la ubicación de p (índice de su sesión, posición de su nodo en el árbol de la sesión e índice local)
+        \coste Logarítmico en el número de problemas del curso
+    */
+    Ubicacion ubicar_problema(int p) const;
+
+    /** @brief Consulta el índice local de un problema
+        \pre p es el índice de un problema de la plataforma
+        \post Retorna el índice local de p dentro del parámetro implícito, o -1 si p no pertenece al curso
+        \coste Logarítmico en el número de problemas del curso
+    */
+    int consultar_local(int p) const;
+
+    /** @brief Consulta qué problema tiene un índice local dado
+        \pre 0 <= j < número de problemas del curso
+        \post Retorna el índice (en la plataforma) del problema con índice local j
+        \coste Constante
+    */
+    int consultar_problema_local(int j) const;
+
+    /** @brief Consulta el número de problemas que forman el curso
+        \pre <em>cierto</em>
+        \post Retorna el número de problemas del parámetro implícito
+        \coste Constante
+    */
+    int consultar_num_problemas_curso() const;
+
+    /** @brief Consulta la base de la sesión que ocupa la posición i
+        \pre i es un entero entre 1 y el número total de sesiones que contiene el curso
+        \post Retorna el índice local del primer problema de la sesión i (la posición 0 de su árbol)
+        \coste Constante
+    */
+    int consultar_base_sesion_i(int i) const;
 
     /** @brief Consulta cuál es la sesión que ocupa la posición i (respecto al orden en que se leyeron) de entre todas las sesiones del curso
         \pre i es un entero entre 1 y el número total de sesiones que contiene el curso
-        \post Retorna el identificador de la sesión que ocupa la posición i (respecto el orden en que fueron leídas al leer el curso)
+        \post Retorna el índice de la sesión que ocupa la posición i (respecto el orden en que fueron leídas al leer el curso)
         \coste Constante
     */
-    string consultar_sesion_i(int i) const;
+    int consultar_sesion_i(int i) const;
 
     /** @brief Consulta el número de sesiones que forman el curso
         \pre <em>cierto</em>
@@ -65,14 +166,42 @@ public:
     */
     int consultar_num_sesiones_curso() const;
 
+    /** @brief Consulta los enviables de un usuario sin ningún problema del curso resuelto
+        \pre Se han calculado los enviables iniciales del parámetro implícito (ver calcular_enviables_iniciales)
+        \post Retorna los bits (por índice local, en el formato de Usuario) de las raíces de las sesiones del curso, que son los problemas enviables de un usuario que se inscribe sin tener resuelto ningún problema del curso
+        \coste Constante
+    */
+    const vector<unsigned long long>& consultar_enviables_iniciales() const;
+
 
     //Modificadoras
+    /** @brief Marca el inicio de los problemas de una sesión
+        \pre Se está leyendo un curso nuevo, i es la posición de la sesión que se va a tratar a continuación
+        \post Los problemas que se añadan a partir de ahora con insertar_problema (hasta la próxima sesión) son los de la sesión i
+        \coste Constante
+    */
+    void iniciar_sesion_i(int i);
+
     /** @brief Añadir problema en un curso
-        \pre Se está leyendo un curso nuevo, y se está comprobando, sesión por sesión, si es correcto (ie si hay intersección de problemas o no). s es el id de la sesión que se está tratando. p es un problema de dicha sesión
-        \post Si el problema p ya estaba entre los problemas del parámetro implícito, retorna false y no se ha modificado nada. Si no estaba, retorna true y se ha añadido al parámetro implícito la pareja "problema-sesión" (p,s)
-        \coste Logarítmico en el número de problemas del curso
+        \pre Se está leyendo un curso nuevo, sesión por sesión. s es el índice de la sesión que se está tratando. p es el índice de un problema de dicha sesión, y nodo la posición de su nodo en el árbol de la sesión
+        \post Se ha añadido al parámetro implícito el problema p con su ubicación (s, nodo), y con el siguiente índice local libre. Hasta que se llame a ordenar_problemas, no se puede buscar ningún problema del curso
+        \coste Constante (amortizado)
     */
-    bool insertar_problema(string p, string s);
+    void insertar_problema(int p, int s, int nodo);
+
+    /** @brief Acaba de añadir los problemas de un curso
+        \pre Se han añadido al parámetro implícito (con insertar_problema) los problemas de todas sus sesiones
+        \post Los problemas del parámetro implícito se pueden buscar. Retorna false si algún problema se ha añadido más de una vez (es decir, si hay intersección de problemas entre las sesiones), y true si no
+        \coste n log n, siendo n el número de problemas del curso
+    */
+    bool ordenar_problemas();
+
+    /** @brief Calcula los enviables iniciales del curso
+        \pre Se han añadido al parámetro implícito los problemas de todas sus sesiones
+        \post El parámetro implícito tiene guardados los enviables de un usuario sin ningún problema del curso resuelto (la raíz de cada sesión no vacía)
+        \coste Lineal en el número de sesiones más el número de problemas del curso entre 64
+    */
+    void calcular_enviables_iniciales();
 
     /** @brief Modificar los stats
         \pre Un usuario se acaba de matricular correctamente en el parámetro implícito. "completado" es true si el usuario en cuestión tiene todos los problemas del curso resueltos a priori
@@ -88,20 +217,70 @@ public:
     */
     void desinscribir_usuario(bool completado);
 
+    /** @brief Anota un envío a un problema del curso
+        \pre e.local es el índice local de un problema del parámetro implícito, y un usuario inscrito en él acaba de enviarlo
+        \post Se ha sumado uno a los envíos del problema; si e.correcto, a sus envíos correctos; y si e.primer_intento, a los usuarios que lo han intentado. El usuario que lo ha hecho ha pasado al puesto que le corresponde en la clasificación o, si con el envío ha completado el curso, ha salido de ella
+        \coste Logarítmico en el número de usuarios inscritos en el curso
+    */
+    void anotar_envio(const Envio& e);
+
+    /** @brief Añade un usuario a la clasificación
+        \pre u apunta al identificador de un usuario inscrito en el parámetro implícito (sin haberlo completado) que no está en la clasificación, y que tiene "resueltos" problemas del curso resueltos y "envios" envíos en el curso. El identificador no cambia de sitio mientras el usuario esté en la clasificación
+        \post El usuario está en la clasificación del parámetro implícito, con "resueltos" problemas resueltos y "envios" envíos
+        \coste Logarítmico en el número de usuarios inscritos en el curso
+    */
+    void anadir_clasificacion(const string* u, int resueltos, int envios);
+
+    /** @brief Quita un usuario de la clasificación
+        \pre u apunta al identificador de un usuario de la clasificación del parámetro implícito, que tiene "resueltos" problemas resueltos y "envios" envíos en el curso
+        \post El usuario ya no está en la clasificación del parámetro implícito
+        \coste Logarítmico en el número de usuarios inscritos en el curso
+    */
+    void quitar_clasificacion(const string* u, int resueltos, int envios);
+
 
     //Lectura y escritura
     /** @brief Lectura de un curso
-        \pre En el canal de entrada tenemos el numero de sesiones que formaran el curso, y una secuencia de identificadores de las sesiones en cuestión
-        \post Se han guardado en el parámetro implícito los identificadores de las sesiones por orden
+        \pre En el canal de entrada tenemos una secuencia de num_sesiones identificadores de sesiones, todos ellos presentes en ids_sesiones
+        \post Se han guardado en el parámetro implícito los índices de las sesiones por orden
         \coste Lineal en el número de sesiones del curso
     */
-    void leer_sesiones_curso(int num_sesiones);
+    void leer_sesiones_curso(int num_sesiones, const Tabla_ids& ids_sesiones);
 
     /** @brief Escritura de un curso
-        \pre <em>cierto</em>
+        \pre ids_sesiones es la tabla de identificadores de las sesiones de la plataforma
         \post En el canal de salida tenemos el número total de usuarios (actuales o pasados) que han completado el curso, el número de usuarios inscritos actualmente, el número de sesiones que lo forman, y la secuencia de identificadores de las sesiones
         \coste Lineal en el número de sesiones del curso
     */
-    void escribir_curso() const;
+    void escribir_curso(const Tabla_ids& ids_sesiones) const;
+
+    /** @brief Escritura de los contadores de los problemas de un curso
+        \pre ids_problemas es la tabla de identificadores de los problemas de la plataforma
+        \post En el canal de salida tenemos, para cada problema del curso (por orden de índice local, ie sesión por sesión y en preorden), su identificador, el número de envíos que ha recibido dentro del curso, el número de envíos correctos, el número de usuarios que lo han intentado y el número de usuarios que lo han resuelto
+        \coste Lineal en el número de problemas del curso
+    */
+    void escribir_estadisticas(const Tabla_ids& ids_problemas) const;
+
+    /** @brief Escritura de los primeros de la clasificación
+        \pre <em>cierto</em>
+        \post En el canal de salida tenemos, del mejor al peor, los k primeros usuarios de la clasificación del parámetro implícito (todos si hay menos de k), cada uno con su identificador, el número de problemas del curso que tiene resueltos y el número de envíos que ha hecho en el curso
+        \coste Lineal en k
+    */
+    void escribir_clasificacion(int k) const;
+
+    //Lectura y escritura en formato binario
+    /** @brief Escritura de un curso en formato binario
+        \pre f es un fichero binario abierto para escritura
+        \post Se ha escrito en f el contenido del parámetro implícito
+        \coste Lineal en el número de problemas del curso
+    */
+    void guardar(Escritor_binario& f) const;
+
+    /** @brief Lectura de un curso en formato binario
+        \pre En la posición actual de f hay un contenido escrito con guardar
+        \post El parámetro implícito pasa a tener el contenido leído de f, con los enviables iniciales calculados y con la clasificación vacía (la plataforma de usuarios la vuelve a llenar al cargar sus usuarios)
+        \coste n log n, siendo n el número de problemas del curso
+    */
+    void cargar(Lector_binario& f);
 };
 #endif
@@ -0,0 +1,128 @@
+/** @file Escritor.cc
+    @brief Implementación de la clase Escritor
+*/
+#include "Escritor.hh"
+
+thread_local Escritor salida(stdout);
+
+                                                    //Constructora y destructora
+Escritor::Escritor(FILE* f, int mida)
+{
+    this->f = f;
+    buf = vector<char>(mida);
+    usados = 0;
+    silenciado = false;
+    desvio = NULL;
+}
+
+Escritor::~Escritor()
+{
+    vaciar();
+}
+                                                    //Modificadoras
+void Escritor::vaciar()
+{
+    if (desvio != NULL) desvio->append(&buf[0], usados);
+    else {
+        if (usados > 0) fwrite(&buf[0], 1, usados, f);
+        fflush(f);
+    }
+    usados = 0;
+}
+
+void Escritor::silenciar(bool s)
+{
+    silenciado = s;
+}
+
+void Escritor::intercambiar(Escritor& otro)
+{
+    swap(f, otro.f);
+    buf.swap(otro.buf);
+    swap(usados, otro.usados);
+    swap(silenciado, otro.silenciado);
+    swap(desvio, otro.desvio);
+}
+
+void Escritor::desviar(string* destino)
+{
+    desvio = destino;
+}
+
+void Escritor::escribir(const char* s, int n)
+{
+    if (silenciado) return;
+    if (usados + n > int(buf.size())) {
+        vaciar();
+        if (n > int(buf.size())) { //no cabe ni con el buffer vacio: lo escribimos directamente
+            if (desvio != NULL) desvio->append(s, n);
+            else fwrite(s, 1, n, f);
+            return;
+        }
+    }
+    memcpy(&buf[usados], s, n);
+    usados += n;
+}
+
+Escritor& Escritor::operator<<(char x)
+{
+    if (silenciado) return *this;
+    if (usados == int(buf.size())) vaciar();
+    buf[usados++] = x;
+    return *this;
+}
+
+Escritor& Escritor::operator<<(const char* x)
+{
+    escribir(x, strlen(x));
+    return *this;
+}
+
+Escritor& Escritor::operator<<(const string& x)
+{
+    escribir(x.data(), x.size());
+    return *this;
+}
+
+Escritor& Escritor::operator<<(bool x)
+{
+    return *this << (x ? '1' : '0');
+}
+
+Escritor& Escritor::operator<<(int x)
+{
+    return *this << (long long)x;
+}
+
+Escritor& Escritor::operator<<(long long x)
+//el valor absoluto se calcula sin signo: -x no cabe en un long long si x es LLONG_MIN
+{
+    if (x < 0) {
+        *this << '-';
+        return *this << (unsigned long)(0ULL - (unsigned long long)x);
+    }
+    return *this << (unsigned long)x;
+}
+
+Escritor& Escritor::operator<<(unsigned long x)
+//escribimos las cifras de derecha a izquierda en un buffer auxiliar
+{
+    char aux[24];
+    int i = 24;
+    do {
+        aux[--i] = '0' + x%10;
+        x /= 10;
+    } while (x != 0);
+    escribir(aux + i, 24 - i);
+    return *this;
+}
+
+Escritor& Escritor::operator<<(double x)
+//los reales que son enteros (el caso mas habitual en los ratios) se escriben directamente como enteros; el resto con el formato %g de cout
+{
+    if (x >= 0 and x < 1e6 and x == (long long)x) return *this << (long long)x;
+    char aux[32];
+    int n = snprintf(aux, sizeof(aux), "%g", x);
+    escribir(aux, n);
+    return *this;
+}
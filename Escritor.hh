@@ -0,0 +1,112 @@
+/** @file Escritor.hh
+    @brief Especificación de la clase Escritor
+*/
+
+#ifndef _ESCRITOR_HH_
+#define _ESCRITOR_HH_
+
+#ifndef NO_DIAGRAM
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+using namespace std;
+#endif
+
+/** @class Escritor
+    @brief Representa un canal de salida con un buffer grande, que solo se vacía cuando se llena o cuando se pide explícitamente.
+
+    Sustituye a "cout" en todo el programa: las clases escriben con el objeto global "salida" igual que antes escribían con cout (operador <<), pero acabando las líneas con '\\n' en lugar de endl, de manera que no se hace una llamada al sistema por cada línea.
+
+    Cada hilo tiene su propio canal "salida". Los hilos que ejecutan funcionalidades en paralelo desvían el suyo a un string, de manera que el hilo principal puede escribir después los resultados en el orden de la entrada.
+
+    Las operaciones son: escribir caracteres, strings, enteros, booleanos y reales (con el mismo formato que cout), vaciar el buffer, y desviar el contenido a un string.
+*/
+
+class Escritor
+{
+private:
+    /** @brief Fichero en el que se escribe */
+    FILE* f;
+    /** @brief Buffer con lo que todavía no se ha escrito en el fichero */
+    vector<char> buf;
+    /** @brief Número de caracteres ocupados del buffer */
+    int usados;
+    /** @brief Indica si el canal está silenciado (descarta todo lo que se le escribe) */
+    bool silenciado;
+    /** @brief Si no es NULL, string al que se añade el contenido del buffer al vaciarlo (en lugar de escribirlo en el fichero) */
+    string* desvio;
+
+public:
+    //Constructora y destructora
+    /** @brief Creadora a partir de un fichero abierto
+        \pre f es un fichero abierto para escritura
+        \post Se ha creado un canal de salida sobre f, con un buffer de "mida" bytes
+        \coste Lineal en mida
+    */
+    explicit Escritor(FILE* f, int mida = 1 << 16);
+
+    /** @brief Destructora
+        \pre <em>cierto</em>
+        \post Se ha vaciado el buffer en el fichero
+    */
+    ~Escritor();
+
+    //Modificadoras
+    /** @brief Vacía el buffer
+        \pre <em>cierto</em>
+        \post Se ha escrito en el fichero todo el contenido del buffer, que queda vacío
+        \coste Lineal en el contenido del buffer
+    */
+    void vaciar();
+
+    /** @brief Silencia o reactiva el canal
+        \pre <em>cierto</em>
+        \post Si s es true, a partir de ahora se descarta todo lo que se escriba en el canal. Si es false, se vuelve a escribir normalmente
+        \coste Constante
+    */
+    void silenciar(bool s);
+
+    /** @brief Intercambia el contenido de dos canales
+        \pre <em>cierto</em>
+        \post El parámetro implícito pasa a escribir donde escribía otro (con su buffer), y al revés
+        \coste Constante
+    */
+    void intercambiar(Escritor& otro);
+
+    /** @brief Desvía el canal a un string
+        \pre El buffer está vacío
+        \post Si destino no es NULL, a partir de ahora al vaciar el buffer su contenido se añade a *destino en lugar de escribirse en el fichero. Si es NULL, se vuelve a escribir en el fichero
+        \coste Constante
+    */
+    void desviar(string* destino);
+
+    /** @brief Escritura de n caracteres
+        \pre s apunta a n caracteres
+        \post Se han añadido los n caracteres al canal (si el buffer se llena, se vacía)
+        \coste Lineal en n (amortizado)
+    */
+    void escribir(const char* s, int n);
+
+    /** @brief Escritura de un carácter */
+    Escritor& operator<<(char x);
+    /** @brief Escritura de una secuencia de caracteres acabada en '\\0' */
+    Escritor& operator<<(const char* x);
+    /** @brief Escritura de un string */
+    Escritor& operator<<(const string& x);
+    /** @brief Escritura de un booleano (como 0 o 1, igual que cout) */
+    Escritor& operator<<(bool x);
+    /** @brief Escritura de un entero */
+    Escritor& operator<<(int x);
+    /** @brief Escritura de un entero largo */
+    Escritor& operator<<(long long x);
+    /** @brief Escritura de un entero sin signo (por ejemplo, el tamaño de un contenedor) */
+    Escritor& operator<<(unsigned long x);
+    /** @brief Escritura de un real, con el mismo formato que cout (6 cifras significativas) */
+    Escritor& operator<<(double x);
+};
+
+/** @brief Canal de salida estándar del programa (uno por hilo) */
+extern thread_local Escritor salida;
+#endif
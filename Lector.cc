@@ -0,0 +1,184 @@
+/** @file Lector.cc
+    @brief Implementación de la clase Lector
+*/
+#include "Lector.hh"
+
+#ifndef NO_DIAGRAM
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#endif
+
+thread_local Lector entrada(stdin);
+
+                                                    //Constructora
+Lector::Lector(FILE* f, int mida)
+{
+    this->f = f;
+    buf = vector<char>(mida);
+    ini = fin = 0;
+    eof = error = false;
+    copia = NULL;
+    espera = NULL;
+    dato_espera = NULL;
+}
+
+Lector::Lector(const string& texto)
+{
+    f = NULL;
+    buf = vector<char>(texto.begin(), texto.end());
+    buf.push_back(' '); //el buffer nunca puede quedar vacio
+    ini = 0;
+    fin = buf.size();
+    eof = true;
+    error = false;
+    copia = NULL;
+    espera = NULL;
+    dato_espera = NULL;
+}
+                                                    //Consultoras
+bool Lector::fallo() const
+{
+    return error;
+}
+bool Lector::pendiente() const
+{
+    //los separadores que quedan al final del bloque (como el salto de linea del ultimo comando) no cuentan: la siguiente lectura los saltaria y tendria que pedir otro bloque
+    int i = ini;
+    while (i < fin and (unsigned char)buf[i] <= ' ') ++i;
+    return i < fin;
+}
+                                                    //Modificadoras
+void Lector::copiar_en(string* destino)
+{
+    copia = destino;
+}
+
+void Lector::al_esperar(void (*funcion)(void*), void* dato)
+{
+    espera = funcion;
+    dato_espera = dato;
+}
+
+void Lector::intercambiar(Lector& otro)
+{
+    swap(f, otro.f);
+    buf.swap(otro.buf);
+    swap(ini, otro.ini);
+    swap(fin, otro.fin);
+    swap(eof, otro.eof);
+    swap(error, otro.error);
+    swap(copia, otro.copia);
+    swap(espera, otro.espera);
+    swap(dato_espera, otro.dato_espera);
+}
+                                                    //Lectura
+bool Lector::recargar()
+{
+    if (eof) return false;
+    if (espera != NULL) espera(dato_espera);
+    int pendientes = fin - ini;
+    if (ini > 0 and pendientes > 0) memmove(&buf[0], &buf[ini], pendientes);
+    ini = 0;
+    fin = pendientes;
+    if (fin == int(buf.size())) buf.resize(2*buf.size()); //la palabra pendiente ocupa todo el buffer
+    ssize_t llegits;
+    do llegits = read(fileno(f), &buf[fin], buf.size() - fin);
+    while (llegits < 0 and errno == EINTR);
+    if (llegits <= 0) {
+        eof = true;
+        return false;
+    }
+    fin += llegits;
+    return true;
+}
+
+bool Lector::leer_token(Token& t)
+{
+    //saltamos los separadores
+    do {
+        while (ini < fin and (unsigned char)buf[ini] <= ' ') ++ini;
+    } while (ini == fin and recargar());
+    if (ini == fin) {
+        error = true;
+        return false;
+    }
+    //buscamos el final de la palabra (si llega al final del buffer, recargamos y seguimos buscando)
+    int j = ini;
+    while (true) {
+        while (j < fin and (unsigned char)buf[j] > ' ') ++j;
+        if (j < fin or eof) break;
+        int offset = j - ini;
+        bool quedan = recargar(); //recargar mueve la palabra pendiente al principio del buffer
+        j = ini + offset;
+        if (not quedan) break;
+    }
+    t.ini = &buf[ini];
+    t.mida = j - ini;
+    ini = j;
+    error = false;
+    if (copia != NULL) {
+        copia->push_back(' ');
+        copia->append(t.ini, t.mida);
+    }
+    return true;
+}
+
+Lector& Lector::operator>>(string& s)
+//si falla, s queda vacio (y no con lo que tuviera de una lectura anterior)
+{
+    Token t;
+    if (leer_token(t)) s.assign(t.ini, t.mida);
+    else s.clear();
+    return *this;
+}
+
+Lector& Lector::operator>>(int& x)
+//si falla, x queda a 0 (igual que con cin)
+{
+    Token t;
+    x = 0;
+    if (leer_token(t)) {
+        int i = 0;
+        bool negatiu = t.mida > 0 and t.ini[0] == '-';
+        if (negatiu or (t.mida > 0 and t.ini[0] == '+')) i = 1;
+        if (i == t.mida) error = true;
+        //el valor se acumula en un long long, y en cuanto se sale del rango de int la lectura falla (igual que con cin)
+        long long limite = negatiu ? -(long long)INT_MIN : INT_MAX;
+        long long valor = 0;
+        while (i < t.mida and not error) {
+            if (t.ini[i] < '0' or t.ini[i] > '9') error = true;
+            else {
+                valor = 10*valor + (t.ini[i] - '0');
+                if (valor > limite) error = true;
+            }
+            ++i;
+        }
+        if (not error) x = negatiu ? -valor : valor;
+    }
+    return *this;
+}
+
+Lector& Lector::operator>>(bool& b)
+{
+    int x = 0;
+    *this >> x;
+    if (x != 0 and x != 1) error = true; //igual que con cin, solo se aceptan 0 y 1
+    b = x == 1 and not error;
+    return *this;
+}
+
+Lector& Lector::operator>>(double& x)
+//si falla, x queda a 0 (igual que con cin)
+{
+    Token t;
+    x = 0;
+    if (leer_token(t)) {
+        string aux(t.ini, t.mida);
+        char* final;
+        double valor = strtod(aux.c_str(), &final);
+        if (final != aux.c_str() + aux.size()) error = true;
+        else x = valor;
+    }
+    return *this;
+}
@@ -0,0 +1,144 @@
+/** @file Lector.hh
+    @brief Especificación de la clase Lector
+*/
+
+#ifndef _LECTOR_HH_
+#define _LECTOR_HH_
+
+#ifndef NO_DIAGRAM
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+using namespace std;
+#endif
+
+/** @brief Palabra del canal de entrada, vista directamente sobre el buffer del Lector (sin copiarla). Solo es válida hasta la siguiente lectura */
+struct Token {
+    /** @brief Primer carácter de la palabra */
+    const char* ini;
+    /** @brief Número de caracteres de la palabra */
+    int mida;
+
+    /** @brief Consulta si la palabra es igual a s */
+    bool es(const char* s) const { return int(strlen(s)) == mida and memcmp(ini, s, mida) == 0; }
+};
+
+/** @class Lector
+    @brief Representa un canal de entrada que lee por bloques grandes y separa las palabras sin copiarlas.
+
+    Sustituye a "cin" en todo el programa: las clases leen con el objeto global "entrada" igual que antes leían con cin (operador >> para strings, enteros y booleanos). Cada hilo tiene su propio canal "entrada" (por ejemplo, cada conexión del modo servidor lee de la suya).
+
+    Los bloques se leen con read, que retorna lo que ya ha llegado sin esperar a llenar el buffer: así, si el fichero es una tubería o un socket, se pueden tratar los comandos que ya han llegado mientras llegan los siguientes.
+
+    Las operaciones son: leer la siguiente palabra (como Token, sin copia), leer un string, un entero o un booleano, y consultar si la última lectura ha fallado (final del canal).
+*/
+
+class Lector
+{
+private:
+    /** @brief Fichero del que se lee */
+    FILE* f;
+    /** @brief Buffer con el bloque leído */
+    vector<char> buf;
+    /** @brief Posición del primer carácter pendiente de tratar dentro del buffer */
+    int ini;
+    /** @brief Posición que sigue al último carácter válido del buffer */
+    int fin;
+    /** @brief Indica si ya se ha llegado al final del fichero */
+    bool eof;
+    /** @brief Indica si la última lectura ha fallado */
+    bool error;
+    /** @brief Si no es NULL, string al que se añade (precedida de un espacio) cada palabra leída */
+    string* copia;
+    /** @brief Si no es NULL, función a la que se llama (con dato_espera) antes de pedir un bloque al fichero */
+    void (*espera)(void*);
+    /** @brief Parámetro de la función espera */
+    void* dato_espera;
+
+public:
+    //Constructora
+    /** @brief Creadora a partir de un fichero abierto
+        \pre f es un fichero abierto para lectura
+        \post Se ha creado un lector sobre f, con un buffer de "mida" bytes
+        \coste Lineal en mida
+    */
+    explicit Lector(FILE* f, int mida = 1 << 20);
+
+    /** @brief Creadora a partir de un texto
+        \pre <em>cierto</em>
+        \post Se ha creado un lector que lee las palabras de "texto" (y después se encuentra con el final del canal)
+        \coste Lineal en la longitud del texto
+    */
+    explicit Lector(const string& texto);
+
+    //Consultoras
+    /** @brief Consulta si la última lectura ha fallado
+        \pre <em>cierto</em>
+        \post Retorna true si la última lectura no ha encontrado ninguna palabra (o no era un número válido)
+        \coste Constante
+    */
+    bool fallo() const;
+
+    /** @brief Consulta si quedan palabras leídas del fichero pendientes de tratar
+        \pre <em>cierto</em>
+        \post Retorna false si la siguiente lectura tendrá que pedir un bloque nuevo al fichero (y por lo tanto puede quedarse esperando), es decir, si en el buffer solo quedan separadores
+        \coste Lineal en el número de separadores que siguen a la última palabra leída
+    */
+    bool pendiente() const;
+
+    //Modificadoras
+    /** @brief Activa o desactiva la copia de las palabras leídas
+        \pre <em>cierto</em>
+        \post Si destino no es NULL, a partir de ahora cada palabra leída se añade a *destino precedida de un espacio. Si es NULL, se deja de copiar
+        \coste Constante
+    */
+    void copiar_en(string* destino);
+
+    /** @brief Fija la función a la que se llama antes de esperar al fichero
+        \pre <em>cierto</em>
+        \post Si funcion no es NULL, a partir de ahora se llama a funcion(dato) cada vez que hay que pedir un bloque nuevo al fichero, antes de pedirlo (y por lo tanto antes de quedarse esperando). Si es NULL, ya no se llama a ninguna
+        \coste Constante
+    */
+    void al_esperar(void (*funcion)(void*), void* dato);
+
+    /** @brief Intercambia el contenido de dos lectores
+        \pre <em>cierto</em>
+        \post El parámetro implícito pasa a leer de donde leía otro, y al revés
+        \coste Constante
+    */
+    void intercambiar(Lector& otro);
+
+    //Lectura
+    /** @brief Lectura de la siguiente palabra
+        \pre <em>cierto</em>
+        \post Si quedan palabras en el canal, t apunta a la siguiente (dentro del buffer) y retorna true. Si no, retorna false
+        \coste Lineal en la longitud de la palabra (amortizado)
+    */
+    bool leer_token(Token& t);
+
+    /** @brief Lectura de un string (si falla, queda vacío) */
+    Lector& operator>>(string& s);
+
+    /** @brief Lectura de un entero (si falla, queda a 0). Falla si la palabra no es un número o si no cabe en un int */
+    Lector& operator>>(int& x);
+
+    /** @brief Lectura de un booleano escrito como 0 o 1 (si falla, queda a false). Falla si la palabra no es 0 ni 1 */
+    Lector& operator>>(bool& b);
+
+    /** @brief Lectura de un real (si falla, queda a 0) */
+    Lector& operator>>(double& x);
+
+private:
+    /** @brief Lectura del siguiente bloque del fichero
+        \pre <em>cierto</em>
+        \post Si hay función de espera, se ha llamado. Se han movido al principio del buffer los caracteres pendientes [ini, fin), y se ha añadido detrás lo que se ha podido leer del fichero (como mucho hasta llenar el buffer). Retorna false si no se ha podido leer nada (final del fichero o error)
+    */
+    bool recargar();
+};
+
+/** @brief Canal de entrada estándar del programa (uno por hilo) */
+extern thread_local Lector entrada;
+#endif
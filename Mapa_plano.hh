@@ -0,0 +1,146 @@
+/** @file Mapa_plano.hh
+    @brief Especificación e implementación de la clase Mapa_plano
+*/
+
+#ifndef _MAPA_PLANO_HH_
+#define _MAPA_PLANO_HH_
+
+#ifndef NO_DIAGRAM
+#include <vector>
+#include <algorithm>
+using namespace std;
+#endif
+
+/** @brief Tamaño hasta el cual un Mapa_plano busca recorriendo las claves en lugar de hacer búsqueda dicotómica */
+const int BUSQUEDA_LINEAL = 32;
+
+/** @class Mapa_plano
+    @brief Representa un diccionario pequeño de claves K a valores V, guardado en vectores contiguos ordenados por clave.
+
+    Las claves y los valores se guardan en dos vectores paralelos: las búsquedas solo recorren el de claves, que ocupa pocas líneas de caché, y no siguen ningún puntero. Mientras el diccionario es pequeño (como mucho BUSQUEDA_LINEAL claves) se busca recorriendo las claves en orden, que para tan pocas es más rápido que la búsqueda dicotómica; a partir de ese tamaño se hace búsqueda dicotómica. El diccionario se construye de una vez: los elementos se añaden al final sin ordenar y después se ordenan todos juntos (con ordenar), que también detecta las claves repetidas. Así construir un diccionario de n elementos cuesta n log n, en lugar de n² si cada elemento se insertara en su sitio, y después casi todo son consultas.
+
+    Los elementos se pueden recorrer por posición, en orden creciente de clave.
+
+    Las operaciones son: consultar el valor de una clave, consultar el número de elementos, la clave y el valor de la posición i, añadir un elemento sin ordenar, ordenar los elementos, vaciar el diccionario y reservar espacio.
+*/
+template <class K, class V> class Mapa_plano
+{
+private:
+    /** @brief Claves, en orden creciente */
+    vector<K> claves;
+    /** @brief Valor de cada clave (en la misma posición) */
+    vector<V> valores;
+
+    /** @brief Compara dos posiciones por su clave */
+    struct Menor_posicion {
+        const vector<K>& claves;
+        Menor_posicion(const vector<K>& claves) : claves(claves) {}
+        bool operator()(int i, int j) const { return claves[i] < claves[j]; }
+    };
+
+    /** @brief Posición de la primera clave que no es menor que k (el número de claves si no hay ninguna) */
+    int posicion(const K& k) const
+    {
+        int n = claves.size();
+        if (n <= BUSQUEDA_LINEAL) {
+            int i = 0;
+            while (i < n and claves[i] < k) ++i;
+            return i;
+        }
+        return lower_bound(claves.begin(), claves.end(), k) - claves.begin();
+    }
+
+public:
+    //Consultoras
+    /** @brief Consulta el valor de una clave
+        \pre El parámetro implícito está ordenado (no se ha añadido nada desde el último ordenar)
+        \post Retorna un puntero al valor de k, o NULL si k no está en el parámetro implícito. El puntero es válido hasta la próxima modificación
+        \coste Lineal en el número de elementos si hay como mucho BUSQUEDA_LINEAL; si no, logarítmico
+    */
+    const V* consultar(const K& k) const
+    {
+        int i = posicion(k);
+        if (i < claves.size() and not (k < claves[i])) return &valores[i];
+        return NULL;
+    }
+
+    /** @brief Consulta el número de elementos
+        \pre <em>cierto</em>
+        \post Retorna el número de elementos del parámetro implícito
+        \coste Constante
+    */
+    int size() const { return claves.size(); }
+
+    /** @brief Consulta la clave de una posición
+        \pre 0 <= i < size()
+        \post Retorna la i-ésima clave del parámetro implícito, en orden creciente
+        \coste Constante
+    */
+    const K& consultar_clave(int i) const { return claves[i]; }
+
+    /** @brief Consulta el valor de una posición
+        \pre 0 <= i < size()
+        \post Retorna el valor de la i-ésima clave del parámetro implícito
+        \coste Constante
+    */
+    const V& consultar_valor(int i) const { return valores[i]; }
+
+    //Modificadoras
+    /** @brief Añade un elemento al final, sin ordenarlo
+        \pre <em>cierto</em>
+        \post Se ha añadido k con valor v detrás de los elementos del parámetro implícito, que queda sin ordenar hasta el próximo ordenar
+        \coste Constante (amortizado)
+    */
+    void anadir_sin_ordenar(const K& k, const V& v)
+    {
+        claves.push_back(k);
+        valores.push_back(v);
+    }
+
+    /** @brief Ordena los elementos por clave
+        \pre <em>cierto</em>
+        \post Los elementos del parámetro implícito quedan en orden creciente de clave (los de claves iguales, en el orden en que se añadieron). Retorna false si hay alguna clave repetida, y true si no
+        \coste n log n, siendo n el número de elementos
+    */
+    bool ordenar()
+    {
+        int n = claves.size();
+        vector<int> orden(n);
+        for (int i = 0; i < n; ++i) orden[i] = i;
+        stable_sort(orden.begin(), orden.end(), Menor_posicion(claves));
+        vector<K> c(n);
+        vector<V> v(n);
+        bool repetidas = false;
+        for (int i = 0; i < n; ++i) {
+            c[i] = claves[orden[i]];
+            v[i] = valores[orden[i]];
+            if (i > 0 and not (c[i - 1] < c[i])) repetidas = true;
+        }
+        claves.swap(c);
+        valores.swap(v);
+        return not repetidas;
+    }
+
+    /** @brief Vacía el parámetro implícito
+        \pre <em>cierto</em>
+        \post El parámetro implícito no tiene ningún elemento
+        \coste Lineal en el número de elementos
+    */
+    void clear()
+    {
+        claves.clear();
+        valores.clear();
+    }
+
+    /** @brief Reserva espacio
+        \pre n >= 0
+        \post Se pueden añadir elementos hasta tener n sin que los vectores cambien de sitio
+        \coste Lineal en n
+    */
+    void reservar(int n)
+    {
+        claves.reserve(n);
+        valores.reserve(n);
+    }
+};
+#endif
@@ -4,11 +4,6 @@
 
 #include "Plataforma_material.hh"
 
-typedef map<string, Problema>::iterator it_p;
-typedef map<string, Problema>::const_iterator cit_p;
-typedef map<string, Sesion>::iterator it_s;
-typedef map<string, Sesion>::const_iterator cit_s;
-
 Plataforma_material::Plataforma_material() {}
                                                               //Consultoras
 bool Plataforma_material::esta_curso(int c) const
@@ -22,70 +17,114 @@ int Plataforma_material::consultar_num_sesiones(int c) const
     return Cj_cursos[c-1].consultar_num_sesiones_curso();
 }
 
+const Tabla_ids& Plataforma_material::consultar_ids_problemas() const
+{
+    return ids_problemas;
+}
+
+int Plataforma_material::consultar_indice_problema(const string& p) const
+{
+    return ids_problemas.consultar_indice(p);
+}
+
+Plataforma_material::Clave_ratio Plataforma_material::clave_ratio(int p) const
+{
+    Clave_ratio k;
+    k.ratio = Cj_problemas[p].consultar_ratio();
+    k.id = &ids_problemas.consultar_id(p);
+    k.indice = p;
+    return k;
+}
+
 const Sesion& Plataforma_material::indicador_sesion(int c, int s) const
 {
-  string sesion = Cj_cursos[c-1].consultar_sesion_i(s);
-  cit_s its = Cj_sesiones.find(sesion);
-  return its->second;
+  return Cj_sesiones[Cj_cursos[c-1].consultar_sesion_i(s)];
 }
 
-const Sesion& Plataforma_material::indicador_sesion2(int c, string p) const {
-  string sesion = Cj_cursos[c-1].encontrar_sesion_problema(p);
-  cit_s its = Cj_sesiones.find(sesion);
-  return its->second;
+void Plataforma_material::consultar_sesiones_curso(int c, vector<const Sesion*>& sesiones) const
+{
+  const Curso& curso = Cj_cursos[c-1];
+  int n = curso.consultar_num_sesiones_curso();
+  sesiones.resize(n);
+  for (int i = 1; i <= n; ++i) sesiones[i-1] = &Cj_sesiones[curso.consultar_sesion_i(i)];
 }
 
-string Plataforma_material::sesion_problema(int c, string p) const
-//aprovechamos el hecho que, por como se leen las sesiones, sabemos que no es posible que un problema tenga el identificador "0"
+const Sesion& Plataforma_material::indicador_sesion2(int c, int p, Curso::Ubicacion& ub) const {
+  ub = Cj_cursos[c-1].ubicar_problema(p); //tabla del curso calculada al leerlo: (sesion, nodo, indice local)
+  return Cj_sesiones[ub.sesion];
+}
+
+const Curso& Plataforma_material::consultar_curso(int c) const
+{
+  return Cj_cursos[c-1];
+}
+
+string Plataforma_material::sesion_problema(int c, const string& p) const
 {
     if (not esta_curso(c)) { //coste constante
-        cout << "error: el curso no existe" << endl;
+        salida << "error: el curso no existe" << '\n';
         return "0";
     }
-    string sesion = Cj_cursos[c-1].encontrar_sesion_problema(p); //busca dentro de "curso" (es un map pequeño)
-    if (sesion != "0") return sesion;
+    int problema = ids_problemas.consultar_indice(p); //-1 si el problema no esta en la plataforma
+    int sesion = Cj_cursos[c-1].encontrar_sesion_problema(problema); //busca dentro de "curso" (es un map pequeño)
+    if (sesion != -1) return ids_sesiones.consultar_id(sesion);
 
-    cit_p it = Cj_problemas.find(p); //busca en el dentro de la estructura (grande) que contiene todos los problemas
-    if (it != Cj_problemas.end()) {
-      cout << "error: el problema no pertenece al curso" << endl;
+    if (problema != -1) {
+      salida << "error: el problema no pertenece al curso" << '\n';
       return "0";
     }
     else {
-      cout << "error: el problema no existe" << endl;
+      salida << "error: el problema no existe" << '\n';
       return "0";
     }
 }
                                                         //Modificadoras
-void Plataforma_material::nuevo_problema(string p)
+void Plataforma_material::nuevo_problema(const string& p)
 {
-    Problema pr;
-    pair<it_p, bool> nou = Cj_problemas.insert (make_pair(p,pr));
-    if (nou.second) cout << Cj_problemas.size() << endl;
-    else cout << "error: el problema ya existe" << endl;
+    if (ids_problemas.consultar_indice(p) != -1) salida << "error: el problema ya existe" << '\n';
+    else {
+      int i = ids_problemas.anadir(p);
+      Cj_problemas.push_back(Problema());
+      indice_ratios.insert(clave_ratio(i));
+      salida << Cj_problemas.size() << '\n';
+    }
 }
 
-void Plataforma_material::nueva_sesion(string s)
+void Plataforma_material::nueva_sesion(const string& s)
 {
     Sesion se;
-    se.leer_sesion();
-    pair<it_s, bool> nou = Cj_sesiones.insert(make_pair(s,se));
-    if (nou.second) cout << Cj_sesiones.size() << endl;
-    else cout << "error: la sesion ya existe" << endl;
+    se.leer_sesion(ids_problemas);
+    if (ids_sesiones.consultar_indice(s) != -1) salida << "error: la sesion ya existe" << '\n';
+    else {
+      ids_sesiones.anadir(s);
+      Cj_sesiones.push_back(se);
+      salida << Cj_sesiones.size() << '\n';
+    }
 }
 
 void Plataforma_material::nuevo_curso()
 {
     bool correcto = leer_curso();
-    if (correcto) cout << Cj_cursos.size() << endl; //si es correcto, el curso ya se ha anadido a la plataforma en el metodo "leer_curso"
-    else cout << "error: curso mal formado" << endl;
+    if (correcto) salida << Cj_cursos.size() << '\n'; //si es correcto, el curso ya se ha anadido a la plataforma en el metodo "leer_curso"
+    else salida << "error: curso mal formado" << '\n';
 }
 
-void Plataforma_material::actualizar_problema_plataforma(string p, bool r)
+void Plataforma_material::actualizar_problema_plataforma(int p, bool r)
 //esta funcion se llama desde Plataforma_usuarios, cuando se hace un envio, a fin de poder actualizar los stats del problema que se envia
+//el problema cambia de ratio, asi que lo sacamos del indice por ratio antes de modificarlo y lo volvemos a poner despues
+{
+    indice_ratios.erase(clave_ratio(p));
+    Cj_problemas[p].anadir_envio_total_problema();
+    if (r) Cj_problemas[p].anadir_envio_correcto_problema();
+    indice_ratios.insert(clave_ratio(p));
+}
+
+void Plataforma_material::sumar_envios_problema(int p, int totales, int correctos)
+//como actualizar_problema_plataforma, pero con todos los envios de un lote al problema a la vez: el indice por ratio solo se toca una vez
 {
-    it_p it = Cj_problemas.find(p);
-    it->second.anadir_envio_total_problema();
-    if (r) it->second.anadir_envio_correcto_problema();
+    indice_ratios.erase(clave_ratio(p));
+    Cj_problemas[p].anadir_envios_problema(totales, correctos);
+    indice_ratios.insert(clave_ratio(p));
 }
 
 int Plataforma_material::modificar_stats_curso (int c, bool completado)
@@ -99,31 +138,50 @@ void Plataforma_material::restar_inscritos(int c, bool completado) {
     Cj_cursos[c-1].desinscribir_usuario(completado);
 }
 
+void Plataforma_material::anotar_envio_curso(const Curso::Envio& e)
+{
+    Cj_cursos[e.curso-1].anotar_envio(e);
+}
+
+void Plataforma_material::anadir_clasificacion_curso(int c, const string* u, int resueltos, int envios)
+{
+    Cj_cursos[c-1].anadir_clasificacion(u, resueltos, envios);
+}
+
+void Plataforma_material::quitar_clasificacion_curso(int c, const string* u, int resueltos, int envios)
+{
+    Cj_cursos[c-1].quitar_clasificacion(u, resueltos, envios);
+}
+
                                                         //Lectura y escritura
 void Plataforma_material::leer_cj_problemas()
 //lee un entero P seguido de P problemas, que pasan a formar parte de la plataforma
 {
     int P;
-    cin >> P;
+    entrada >> P;
     string id;
-    Problema pr;
     for (int i = 0; i < P; ++i) {
-        cin >> id;
-        Cj_problemas.insert(make_pair(id, pr));
+        entrada >> id;
+        ids_problemas.anadir(id);
     }
+    Cj_problemas = vector<Problema>(ids_problemas.size());
+    for (int i = 0; i < Cj_problemas.size(); ++i) indice_ratios.insert(clave_ratio(i));
 }
 
 void Plataforma_material::leer_cj_sesiones()
 //lee un entero Q seguido de Q sesiones, que pasan a formar parte de la plataforma
 {
     int Q;
-    cin >> Q;
+    entrada >> Q;
     string id;
-    Sesion s;
     for (int i = 0; i < Q; ++i) {
-        cin >> id;
-        s.leer_sesion();
-        Cj_sesiones.insert(make_pair(id, s));
+        entrada >> id;
+        Sesion s;
+        s.leer_sesion(ids_problemas);
+        if (ids_sesiones.consultar_indice(id) == -1) {
+          ids_sesiones.anadir(id);
+          Cj_sesiones.push_back(s);
+        }
     }
 }
 
@@ -134,19 +192,21 @@ bool Plataforma_material::leer_curso()
 //aunque en la lectura inicial de cursos no hace falta comprobar que la interseccion de problemas sea correcta, he optado por utilizar en este caso tambien el metodo "intersession"
 //puesto que permite crear en Curso una estructura de datos que contiene todos los problemas aparejados con la sesion a la que pertenecen (que sera util para funciones del Evaluator)
 
-//coste: num_sesiones * constante * log(Q) * .. * constante
+//coste: n log n, siendo n el número de problemas del curso (se añaden todos sin ordenar y se ordenan una sola vez al final)
 {
-  int num_sesiones; cin >> num_sesiones;
+  int num_sesiones; entrada >> num_sesiones;
   Curso c(num_sesiones);
-  c.leer_sesiones_curso(num_sesiones);
-  int i = 1; bool ok = true;
-  while (i <= num_sesiones and ok) {
-    string s = c.consultar_sesion_i(i); //busca en el curso cual es la sesion "i"
-    cit_s it = Cj_sesiones.find(s); //encuentra la sesion en la plataforma
-    ok = it->second.interseccion(c,s); //modifica el curso para anadirle la estructura de datos que contiene las parejas "problema-sesion"
-    ++i;
+  c.leer_sesiones_curso(num_sesiones, ids_sesiones);
+  for (int i = 1; i <= num_sesiones; ++i) {
+    int s = c.consultar_sesion_i(i); //busca en el curso cual es la sesion "i"
+    c.iniciar_sesion_i(i); //los problemas de la sesion "i" ocupan los siguientes indices locales del curso
+    Cj_sesiones[s].interseccion(c,s); //modifica el curso para anadirle la estructura de datos que contiene las parejas "problema-sesion"
+  }
+  bool ok = c.ordenar_problemas(); //si algun problema esta en dos sesiones, el curso esta mal formado
+  if (ok) { //si el curso leido es correcto, se anade a la plataforma
+    c.calcular_enviables_iniciales(); //los enviables de los usuarios que se inscriban sin nada resuelto, que son la mayoria
+    Cj_cursos.push_back(c);
   }
-  if (ok) Cj_cursos.push_back(c); //si el curso leido es correcto, se anade a la plataforma
   return ok;
 }
 
@@ -154,60 +214,116 @@ void Plataforma_material::leer_cj_cursos()
 //lee un entero N seguido de N cursos, que pasan a formar parte de la plataforma
 {
     int N;
-    cin >> N;
+    entrada >> N;
     for (int i = 1; i <= N; ++i) leer_curso();
 }
 
 
-bool Plataforma_material::comp_ratios(const pair <pair<string,Problema>, double>& p1, const pair <pair<string,Problema>, double>& p2) {
-    if (p1.second == p2.second) return p1.first.first < p2.first.first;
-    return p1.second < p2.second;
+void Plataforma_material::listar_problemas() const
+//el indice por ratio ya esta ordenado, basta con recorrerlo
+{
+    for (set<Clave_ratio, Menor_ratio>::const_iterator it = indice_ratios.begin(); it != indice_ratios.end(); ++it) {
+        salida << *it->id;
+        Cj_problemas[it->indice].escribir_problema();
+    }
+}
+
+void Plataforma_material::listar_problemas_pagina(const string& desde, int n) const
+//el cursor es un problema: la pagina empieza en su posicion actual del indice por ratio
+{
+    int p = desde == DESDE_INICIO ? -1 : ids_problemas.consultar_indice(desde);
+    if (desde != DESDE_INICIO and p == -1) salida << "error: el problema no existe" << '\n';
+    else {
+        set<Clave_ratio, Menor_ratio>::const_iterator it = p == -1 ? indice_ratios.begin() : indice_ratios.lower_bound(clave_ratio(p));
+        for (int i = 0; i < n and it != indice_ratios.end(); ++i, ++it) {
+            salida << *it->id;
+            Cj_problemas[it->indice].escribir_problema();
+        }
+        if (it != indice_ratios.end()) salida << "siguiente " << *it->id << '\n';
+    }
+}
+
+void Plataforma_material::listar_problemas_faciles(int k) const
+{
+    set<Clave_ratio, Menor_ratio>::const_iterator it = indice_ratios.begin();
+    for (int i = 0; i < k and it != indice_ratios.end(); ++i) {
+        salida << *it->id;
+        Cj_problemas[it->indice].escribir_problema();
+        ++it;
+    }
 }
 
-void Plataforma_material::listar_problemas() const
+void Plataforma_material::listar_problemas_dificiles(int k) const
 {
-    cit_p it = Cj_problemas.begin();
-    int mida = Cj_problemas.size();
-    vector < pair <pair<string,Problema>, double> > v(mida); //construimos un vector con los problemas, identificadores y ratios, que nos servira para ordenar
-    for (int i = 0; i < mida; ++i){
-        v[i].first = *it;
-        v[i].second = it->second.consultar_ratio();
+    set<Clave_ratio, Menor_ratio>::const_reverse_iterator it = indice_ratios.rbegin();
+    for (int i = 0; i < k and it != indice_ratios.rend(); ++i) {
+        salida << *it->id;
+        Cj_problemas[it->indice].escribir_problema();
         ++it;
     }
-    sort(v.begin(), v.end(), comp_ratios);
-    for(int i = 0; i < mida; ++i){
-        cout << v[i].first.first;
-        v[i].first.second.escribir_problema();
+}
+
+void Plataforma_material::listar_problemas_ratio(double a, double b) const
+//buscamos el primer problema con ratio >= a (la clave con el identificador vacio va delante de todas las de su ratio) y avanzamos mientras el ratio no pase de b
+{
+    string vacio;
+    Clave_ratio desde;
+    desde.ratio = a;
+    desde.id = &vacio;
+    desde.indice = -1;
+    for (set<Clave_ratio, Menor_ratio>::const_iterator it = indice_ratios.lower_bound(desde); it != indice_ratios.end() and it->ratio <= b; ++it) {
+        salida << *it->id;
+        Cj_problemas[it->indice].escribir_problema();
     }
 }
 
-void Plataforma_material::escribir_problema(string p) const
+void Plataforma_material::escribir_problema(const string& p) const
 {
-    cit_p it = Cj_problemas.find(p);
-    if (it == Cj_problemas.end()) cout << "error: el problema no existe" << endl;
+    int i = ids_problemas.consultar_indice(p);
+    if (i == -1) salida << "error: el problema no existe" << '\n';
     else {
-      cout << it->first;
-      it->second.escribir_problema();
+      salida << p;
+      Cj_problemas[i].escribir_problema();
+    }
+}
+
+void Plataforma_material::buscar_problemas(const string& desde, const string& hasta) const
+//la tabla de identificadores ya tiene los problemas ordenados por identificador
+{
+    for (Tabla_ids::const_iterator it = ids_problemas.desde(desde); it != ids_problemas.end() and *it->first <= hasta; ++it) {
+        salida << *it->first;
+        Cj_problemas[it->second].escribir_problema();
     }
 }
 
 void Plataforma_material::listar_sesiones() const
 {
-    for (cit_s it = Cj_sesiones.begin(); it != Cj_sesiones.end(); ++it) {
-        cout << it->first << " ";
-        it->second.escribir_sesion();
-        cout << endl;
+    for (Tabla_ids::const_iterator it = ids_sesiones.begin(); it != ids_sesiones.end(); ++it) {
+        salida << *it->first << " ";
+        Cj_sesiones[it->second].escribir_sesion(ids_problemas);
+        salida << '\n';
     }
 }
 
-void Plataforma_material::escribir_sesion(string s) const
+void Plataforma_material::listar_sesiones_pagina(const string& desde, int n) const
 {
-    cit_s it = Cj_sesiones.find(s);
-    if (it == Cj_sesiones.end()) cout << "error: la sesion no existe" << endl;
+    Tabla_ids::const_iterator it = desde == DESDE_INICIO ? ids_sesiones.begin() : ids_sesiones.desde(desde);
+    for (int i = 0; i < n and it != ids_sesiones.end(); ++i, ++it) {
+        salida << *it->first << " ";
+        Cj_sesiones[it->second].escribir_sesion(ids_problemas);
+        salida << '\n';
+    }
+    if (it != ids_sesiones.end()) salida << "siguiente " << *it->first << '\n';
+}
+
+void Plataforma_material::escribir_sesion(const string& s) const
+{
+    int i = ids_sesiones.consultar_indice(s);
+    if (i == -1) salida << "error: la sesion no existe" << '\n';
     else {
-      cout << it->first << " ";
-      it->second.escribir_sesion();
-      cout << endl;
+      salida << s << " ";
+      Cj_sesiones[i].escribir_sesion(ids_problemas);
+      salida << '\n';
     }
 }
 
@@ -215,16 +331,58 @@ void Plataforma_material::listar_cursos() const
 {
     int mida = Cj_cursos.size();
     for (int i = 0; i < mida; ++i) {
-        cout << i+1 << " ";
-        Cj_cursos[i].escribir_curso();
+        salida << i+1 << " ";
+        Cj_cursos[i].escribir_curso(ids_sesiones);
     }
 }
 
 void Plataforma_material::escribir_curso(int c) const
 {
-    if (not esta_curso(c)) cout << "error: el curso no existe" << endl;
+    if (not esta_curso(c)) salida << "error: el curso no existe" << '\n';
     else {
-      cout << c << " ";
-      Cj_cursos[c-1].escribir_curso();
+      salida << c << " ";
+      Cj_cursos[c-1].escribir_curso(ids_sesiones);
+    }
+}
+
+void Plataforma_material::estadisticas_curso(int c) const
+{
+    if (not esta_curso(c)) salida << "error: el curso no existe" << '\n';
+    else Cj_cursos[c-1].escribir_estadisticas(ids_problemas);
+}
+
+void Plataforma_material::ranking_curso(int c, int k) const
+{
+    if (not esta_curso(c)) salida << "error: el curso no existe" << '\n';
+    else Cj_cursos[c-1].escribir_clasificacion(k);
+}
+
+                                                        //Lectura y escritura en formato binario
+void Plataforma_material::guardar(Escritor_binario& f) const
+{
+    ids_problemas.guardar(f);
+    for (int i = 0; i < Cj_problemas.size(); ++i) Cj_problemas[i].guardar(f);
+    ids_sesiones.guardar(f);
+    for (int i = 0; i < Cj_sesiones.size(); ++i) Cj_sesiones[i].guardar(f);
+    f.escribir_entero(Cj_cursos.size());
+    for (int i = 0; i < Cj_cursos.size(); ++i) Cj_cursos[i].guardar(f);
+}
+
+void Plataforma_material::cargar(Lector_binario& f)
+{
+    ids_problemas.cargar(f);
+    Cj_problemas = vector<Problema>(ids_problemas.size());
+    for (int i = 0; i < Cj_problemas.size(); ++i) {
+        Cj_problemas[i].cargar(f);
+        indice_ratios.insert(clave_ratio(i));
+    }
+    ids_sesiones.cargar(f);
+    Cj_sesiones = vector<Sesion>(ids_sesiones.size());
+    for (int i = 0; i < Cj_sesiones.size(); ++i) Cj_sesiones[i].cargar(f);
+    int N = f.leer_cantidad(4*sizeof(int));
+    for (int i = 0; i < N and not f.fallo(); ++i) {
+        Curso c(0);
+        c.cargar(f);
+        Cj_cursos.push_back(c);
     }
 }
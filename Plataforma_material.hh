@@ -8,6 +8,7 @@
 #include "Problema.hh"
 #include "Sesion.hh"
 #include "Curso.hh"
+#include "Tabla_ids.hh"
 
 #ifndef NO_DIAGRAM
 #include <algorithm>
@@ -17,19 +18,39 @@
 /** @class Plataforma_material
     @brief Representa la información y las operaciones asociadas al "Material Docente" (problemas, sesiones y cursos) de la plataforma Evaluator.
 
-    La información viene dada por un conjunto que contiene parejas de un identificador y un problema, otro conjunto que contiene parejas identificador - sesión, y otro que contiene parejas número de curso - curso.
+    La información viene dada por un conjunto que contiene parejas de un identificador y un problema, otro conjunto que contiene parejas identificador - sesión, y otro que contiene parejas número de curso - curso. Los identificadores de problemas y de sesiones se guardan una sola vez en una tabla de símbolos, y el resto de estructuras (de esta clase y de las demás) trabajan con el índice que la tabla les asigna.
 
-    Las operaciones son: consultoras de si un curso está en la plataforma, del numero de sesiones que tiene un curso dado, de la Sesion que ocupa cierta posición dentro de un curso, de la Sesion que contiene cierto problema dentro de un curso, o del identificador de la Sesion que contiene cierto problema. Las modificadoras permiten añadir un problema, o una sesión, o un curso a la plataforma, o bien actualizar la información de un problema dado (cuando algún usuario hace envíos, por ejemplo), o la de un curso dado (cuando un usuario se inscribe / desinscribe, por ejemplo). Las de lectura permiten leer o bien el conjunto de problemas, de sesiones o de cursos, o también permiten leer un curso particular. Las de escritura permiten escribir o bien un problema, una sesión o un curso dado, o bien el conjunto entero de problemas, sesiones o cursos.
+    Las operaciones son: consultoras de si un curso está en la plataforma, del numero de sesiones que tiene un curso dado, de la Sesion que ocupa cierta posición dentro de un curso, de la Sesion que contiene cierto problema dentro de un curso, o del identificador de la Sesion que contiene cierto problema. Las modificadoras permiten añadir un problema, o una sesión, o un curso a la plataforma, o bien actualizar la información de un problema dado (cuando algún usuario hace envíos, por ejemplo), o la de un curso dado (cuando un usuario se inscribe / desinscribe, o cuando envía uno de sus problemas, por ejemplo). Las de lectura permiten leer o bien el conjunto de problemas, de sesiones o de cursos, o también permiten leer un curso particular. Las de escritura permiten escribir o bien un problema, una sesión o un curso dado, o bien el conjunto entero de problemas, sesiones o cursos, o bien los contadores de los problemas o la clasificación de un curso.
 
     */
 
 class Plataforma_material
 {
 private:
-    /** @brief Estructura que contiene todos los problemas disponibles en la plataforma */
-    map<string, Problema> Cj_problemas;
-    /** @brief Estructura que contiene todas las sesiones disponibles en la plataforma */
-    map<string, Sesion> Cj_sesiones;
+    /** @brief Clave del índice de problemas por ratio: ratio, identificador e índice del problema */
+    struct Clave_ratio {
+        double ratio;
+        const string* id;
+        int indice;
+    };
+    /** @brief Orden del índice de problemas por ratio: de menor a mayor ratio, y a igual ratio de menor a mayor identificador */
+    struct Menor_ratio {
+        bool operator()(const Clave_ratio& a, const Clave_ratio& b) const {
+            if (a.ratio != b.ratio) return a.ratio < b.ratio;
+            return *a.id < *b.id;
+        }
+    };
+
+    /** @brief Tabla de identificadores de los problemas de la plataforma */
+    Tabla_ids ids_problemas;
+    /** @brief Estructura que contiene todos los problemas disponibles en la plataforma (la posición i contiene el problema de índice i) */
+    vector<Problema> Cj_problemas;
+    /** @brief Índice de todos los problemas de la plataforma, ordenados por ratio (y a igual ratio, por identificador) */
+    set<Clave_ratio, Menor_ratio> indice_ratios;
+    /** @brief Tabla de identificadores de las sesiones de la plataforma */
+    Tabla_ids ids_sesiones;
+    /** @brief Estructura que contiene todas las sesiones disponibles en la plataforma (la posición i contiene la sesión de índice i) */
+    vector<Sesion> Cj_sesiones;
     /** @brief Estructura que contiene todos los cursos disponibles en la plataforma (ordenados por orden en que se añadieron a la plataforma) */
     vector<Curso> Cj_cursos;
 
@@ -58,26 +79,54 @@ public:
     */
     int consultar_num_sesiones(int c) const;
 
+    /** @brief Consulta la tabla de identificadores de los problemas
+        \pre <em>cierto</em>
+        \post Retorna la tabla que asocia a cada identificador de problema de la plataforma su índice
+        \coste Constante
+    */
+    const Tabla_ids& consultar_ids_problemas() const;
+
+    /** @brief Consulta el índice de un problema
+        \pre <em>cierto</em>
+        \post Retorna el índice del problema con identificador p si está en la plataforma, -1 si no lo está
+        \coste Constante (en media)
+    */
+    int consultar_indice_problema(const string& p) const;
+
     /** @brief Consulta cuál es la sesión número "s" (respecto el orden en el que se han leído) del curso c
         \pre c es un identificador válido de curso, s es un número entre 1 y el número total de sesiones de ese curso
         \post Retorna la Sesion que se encuentra en la posición "s" dentro del curso c
-        \coste Logarítmico en Q (número de sesiones)
+        \coste Constante
     */
     const Sesion& indicador_sesion(int c, int s) const;
 
+    /** @brief Consulta todas las sesiones de un curso
+        \pre c es un identificador válido de curso
+        \post sesiones contiene, en orden, un puntero a cada una de las sesiones del curso c (la posición i-1 contiene la sesión número i)
+        \coste Lineal en el número de sesiones del curso
+    */
+    void consultar_sesiones_curso(int c, vector<const Sesion*>& sesiones) const;
+
     /** @brief Consulta cuál es la sesión que contiene un problema dado
-        \pre c es un identificador válido de curso, p un identificador de un problema válido que pertenece al curso c
-        \post Retorna la Sesion que contiene el problema p
-        \coste Logarítmico en Q (número de sesiones)
+        \pre c es un identificador válido de curso, p el índice de un problema válido que pertenece al curso c
+        \post Retorna la Sesion que contiene el problema p, y ub pasa a ser la ubicación de p dentro del curso c
+        \coste Constante (en media)
+    */
+    const Sesion& indicador_sesion2(int c, int p, Curso::Ubicacion& ub) const;
+
+    /** @brief Consulta un curso
+        \pre c es un identificador válido de curso
+        \post Retorna el curso c
+        \coste Constante
     */
-    const Sesion& indicador_sesion2(int c, string p) const;
+    const Curso& consultar_curso(int c) const;
 
     /** @brief Consulta, dentro de un curso, a qué sesión pertenece el problema p
         \pre c es el identificador del curso, p el identifcador del problema que estamos consultando
         \post Si el curso c no existe, o si el problema p no existe en la plataforma, o si p no pertenece al curso, salta un error. Si no, se busca en cuál de las sesiones del curso está el problema, y retorna el identificador de la sesión
         \coste Logarítmico en P (número de problemas)
     */
-    string sesion_problema(int c, string p) const;
+    string sesion_problema(int c, const string& p) const;
 
 
     //Modificadoras
@@ -86,15 +135,15 @@ public:
         \post Si el problema con identificador p está en la plataforma, salta un error. Si no está, se ha añadido el problema de identificador p y se imprime el número de problemas de la plataforma después de añadirlo
         \coste Logarítmico en P (número de problemas)
     */
-    void nuevo_problema(string p);
+    void nuevo_problema(const string& p);
 
 
     /** @brief Operación de leer y añadir una sesión a la plataforma
         \pre s es el identificador de la sesión que se quiere añadir
         \post Si la sesión con identificador s está en la plataforma, salta un error. Si no está, se ha añadido la sesión de identificador s y se imprime el número de sesiones de la plataforma después de añadirla
-        \coste (número de problemas de la sesión)*log(Q)
+        \coste Lineal en el número de problemas de la sesión
     */
-    void nueva_sesion(string s);
+    void nueva_sesion(const string& s);
 
     /** @brief Operación de leer y añadir un curso a la plataforma
         \pre <em>cierto</em>
@@ -103,11 +152,18 @@ public:
     void nuevo_curso();
 
     /** @brief Actualiza la información de un problema de la plataforma
-        \pre p es un problema correcto de la plataforma, r indica si p se ha resuelto con éxito o no
-        \post Se ha modificado el problema p de la plataforma, añadiéndole uno al número de envío total. Además, se ha añadido un envío más al número de envíos correctos si r era true
+        \pre p es el índice de un problema correcto de la plataforma, r indica si p se ha resuelto con éxito o no
+        \post Se ha modificado el problema p de la plataforma, añadiéndole uno al número de envío total. Además, se ha añadido un envío más al número de envíos correctos si r era true. El índice por ratio queda actualizado
+        \coste Logarítmico en P (número de problemas)
+    */
+    void actualizar_problema_plataforma(int p, bool r);
+
+    /** @brief Suma varios envíos a un problema de la plataforma
+        \pre p es el índice de un problema correcto de la plataforma, 0 <= correctos <= totales
+        \post Se han añadido al problema p "totales" envíos, de los cuales "correctos" correctos. El índice por ratio queda actualizado
         \coste Logarítmico en P (número de problemas)
     */
-    void actualizar_problema_plataforma(string p, bool r);
+    void sumar_envios_problema(int p, int totales, int correctos);
 
     /** @brief Operación de actualizar los stats de un curso
         \pre c es el identificador del curso. Un usuario de Plataforma_usuarios se acaba de inscribir un el curso. "completado" es true si el usuario en cuestión ya tiene resueltos todos los problemas del curso resueltos, false si no
@@ -123,19 +179,40 @@ public:
     */
     void restar_inscritos(int c, bool completado);
 
+    /** @brief Operación de anotar un envío en los contadores de un curso
+        \pre e.curso es el identificador de un curso de la plataforma y e.local el índice local de uno de sus problemas, que un usuario inscrito en el curso acaba de enviar
+        \post Se ha anotado el envío en los contadores del problema dentro del curso e.curso
+        \coste Constante
+    */
+    void anotar_envio_curso(const Curso::Envio& e);
+
+    /** @brief Operación de añadir un usuario a la clasificación de un curso
+        \pre c es el identificador de un curso de la plataforma en el que está inscrito (sin haberlo completado) el usuario con identificador *u, que tiene "resueltos" problemas del curso resueltos y ha hecho "envios" envíos en el curso. El usuario no está en la clasificación
+        \post El usuario está en la clasificación del curso c
+        \coste Logarítmico en el número de usuarios inscritos en el curso
+    */
+    void anadir_clasificacion_curso(int c, const string* u, int resueltos, int envios);
+
+    /** @brief Operación de quitar un usuario de la clasificación de un curso
+        \pre c es el identificador de un curso de la plataforma, y el usuario con identificador *u está en su clasificación con "resueltos" problemas resueltos y "envios" envíos
+        \post El usuario ya no está en la clasificación del curso c
+        \coste Logarítmico en el número de usuarios inscritos en el curso
+    */
+    void quitar_clasificacion_curso(int c, const string* u, int resueltos, int envios);
+
 
     //Lectura y escritura
     /** @brief Lectura de un conjunto de problemas para inicializar la plataforma
         \pre <em>cierto</em>
         \post Se ha leído un número entero P, seguido de P problemas y estos pasan a formar parte de la plataforma de material
-        \coste P * logP
+        \coste Lineal en P (en media)
     */
     void leer_cj_problemas();
 
     /** @brief Lectura de un conjunto de sesiones para inicializar la plataforma
         \pre <em>cierto</em>
         \post Se ha leído un número entero Q, seguido de Q sesiones y pasan a formar parte de la plataforma
-        \coste Q * logQ
+        \coste Lineal en el número total de problemas de las Q sesiones (en media)
     */
     void leer_cj_sesiones();
 
@@ -154,15 +231,51 @@ public:
     /** @brief Escritura de los problemas de la plataforma
         \pre <em>cierto</em>
         \post Se escriben en el canal de salida todos los problemas de la plataforma, ordenados por ratio (de menor a mayor) (para cada problema se escribe: identificador, envíos totales, envíos correctos y ratio)
+        \coste Lineal en P (número de problemas)
     */
     void listar_problemas() const;
 
+    /** @brief Escritura de una página de los problemas de la plataforma
+        \pre desde es DESDE_INICIO o el identificador de un problema (normalmente, el cursor que ha escrito la página anterior); n >= 0
+        \post Si desde no es DESDE_INICIO ni un problema de la plataforma, salta un error. Si no, se escriben (como en listar_problemas, por ratio) los n primeros problemas a partir del principio o a partir del problema desde (incluido), según su ratio actual. Si quedan más problemas detrás, se escribe "siguiente" seguido del identificador del primero que falta, que es el cursor de la página siguiente. Si el ratio de un problema cambia entre dos páginas, el problema puede salir dos veces o ninguna
+        \coste Logarítmico en P (número de problemas), más lineal en n
+    */
+    void listar_problemas_pagina(const string& desde, int n) const;
+
+    /** @brief Escritura de los problemas más fáciles de la plataforma
+        \pre <em>cierto</em>
+        \post Se escriben en el canal de salida los k problemas de menor ratio (o todos, si hay menos de k), en el mismo orden y formato que listar_problemas
+        \coste Logarítmico en P + k
+    */
+    void listar_problemas_faciles(int k) const;
+
+    /** @brief Escritura de los problemas más difíciles de la plataforma
+        \pre <em>cierto</em>
+        \post Se escriben en el canal de salida los k problemas de mayor ratio (o todos, si hay menos de k), de mayor a menor ratio (y a igual ratio, de mayor a menor identificador), con el mismo formato que listar_problemas
+        \coste Logarítmico en P + k
+    */
+    void listar_problemas_dificiles(int k) const;
+
+    /** @brief Escritura de los problemas de la plataforma con el ratio dentro de un intervalo
+        \pre <em>cierto</em>
+        \post Se escriben en el canal de salida todos los problemas con ratio entre a y b (ambos incluidos), en el mismo orden y formato que listar_problemas
+        \coste Logarítmico en P + número de problemas escritos
+    */
+    void listar_problemas_ratio(double a, double b) const;
+
     /** @brief Escritura de un problema de la plataforma
         \pre p es el identificador del problema que se quiere escribir
         \post Si p no está en la plataforma, salta un error. Si está, se imprime la información del problema (identificador, envíos totales, envíos correctos y ratio)
-        \coste Logarítmico
+        \coste Constante (en media)
+    */
+    void escribir_problema(const string& p) const;
+
+    /** @brief Escritura de los problemas de un intervalo de identificadores
+        \pre <em>cierto</em>
+        \post Se escriben en el canal de salida, ordenados por identificador, los problemas de la plataforma con identificador entre desde y hasta (ambos incluidos, aunque no sean problemas de la plataforma); para cada uno se escribe lo mismo que en escribir_problema
+        \coste Logarítmico en P (número de problemas), más lineal en el número de problemas escritos
     */
-    void escribir_problema(string p) const;
+    void buscar_problemas(const string& desde, const string& hasta) const;
 
     /** @brief Escritura de las sesiones de la plataforma
         \pre <em>cierto</em>
@@ -171,12 +284,19 @@ public:
     */
     void listar_sesiones() const;
 
+    /** @brief Escritura de una página de las sesiones de la plataforma
+        \pre desde es DESDE_INICIO o un identificador cualquiera (normalmente, el cursor que ha escrito la página anterior); n >= 0
+        \post Se escriben (como en listar_sesiones) las n primeras sesiones con identificador no menor que desde (desde la primera, si desde es DESDE_INICIO). Si quedan más sesiones detrás, se escribe "siguiente" seguido del identificador de la primera que falta, que es el cursor de la página siguiente. Como las páginas se ordenan por identificador, que no cambia, cada sesión que está en la plataforma durante todo el recorrido sale exactamente una vez
+        \coste Logarítmico en el número de sesiones, más lineal en el tamaño de las n sesiones escritas
+    */
+    void listar_sesiones_pagina(const string& desde, int n) const;
+
     /** @brief Escritura de una sesión de la plataforma
         \pre s es el identifcador de la sesión que se quiere escribir
         \post Si s no está en la plataforma, salta un error. Si está, se imprime la información de la sesión s (identificador, número de problemas, e identificadores (en postorden) de los problemas)
-        \coste (número de problemas de la sesión) * (logQ)
+        \coste Lineal en el número de problemas de la sesión
     */
-    void escribir_sesion(string s) const;
+    void escribir_sesion(const string& s) const;
 
     /** @brief Escritura de los cursos de la plataforma
         \pre <em>cierto</em>
@@ -192,11 +312,40 @@ public:
     */
     void escribir_curso(int c) const;
 
+    /** @brief Escritura de los contadores de los problemas de un curso de la plataforma
+        \pre c es el identificador del curso que se quiere consultar
+        \post Si c no está en la plataforma, salta un error. Si está, se imprime, para cada problema del curso (sesión por sesión, y dentro de cada sesión en preorden), su identificador seguido del número de envíos que ha recibido dentro del curso, el número de envíos correctos, el número de usuarios que lo han intentado y el número de usuarios que lo han resuelto
+        \coste Lineal en el número de problemas del curso
+    */
+    void estadisticas_curso(int c) const;
+
+    /** @brief Escritura de los primeros de la clasificación de un curso de la plataforma
+        \pre c es el identificador del curso que se quiere consultar
+        \post Si c no está en la plataforma, salta un error. Si está, se imprimen los k usuarios inscritos en el curso con más problemas del curso resueltos y, a igualdad, con menos envíos en el curso (todos si hay menos de k), cada uno con su identificador, sus problemas resueltos y sus envíos
+        \coste Lineal en k
+    */
+    void ranking_curso(int c, int k) const;
+
+    //Lectura y escritura en formato binario
+    /** @brief Escritura de la plataforma de material en formato binario
+        \pre f es un fichero binario abierto para escritura
+        \post Se han escrito en f los identificadores y el contenido de todos los problemas, sesiones y cursos de la plataforma (incluidos los stats de problemas y cursos)
+        \coste Lineal en el tamaño de la plataforma
+    */
+    void guardar(Escritor_binario& f) const;
+
+    /** @brief Lectura de la plataforma de material en formato binario
+        \pre El parámetro implícito está vacío. En la posición actual de f hay una plataforma escrita con guardar
+        \post El parámetro implícito pasa a tener el contenido leído de f
+    */
+    void cargar(Lector_binario& f);
+
 private:
-    /** @brief Función de ordenación del vector de Problemas por ratio
-        \pre p1 y p2 son dos elementos del vector que se quieren comparar
-        \post Retorna true si el ratio del primer problema es mayor al del segundo, o si los ratios son iguales pero el string del primero es mayor
+    /** @brief Clave de un problema en el índice por ratio
+        \pre p es el índice de un problema de la plataforma
+        \post Retorna la clave (ratio actual, identificador, índice) del problema p
+        \coste Constante
     */
-    static bool comp_ratios(const pair <pair<string,Problema>, double>& p1, const pair <pair<string,Problema>, double>& p2);
+    Clave_ratio clave_ratio(int p) const;
 };
 #endif
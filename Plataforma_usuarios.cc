@@ -5,80 +5,260 @@
 #include "Plataforma_usuarios.hh"
 #include "Plataforma_material.hh"
 
-typedef map<string, Usuario>::iterator it_u;
-typedef map<string, Usuario>::const_iterator cit_u;
-typedef map<string, Problema>::iterator it_p;
-typedef map<string, Problema>::const_iterator cit_p;
-typedef map<string, Sesion>::iterator it_s;
-typedef map<string, Sesion>::const_iterator cit_s;
-
-Plataforma_usuarios::Plataforma_usuarios() {}
+Plataforma_usuarios::Plataforma_usuarios() : orden(Menor_id(), Indice_usuarios::allocator_type(&pool_orden)) {}
                                                         //Consultoras
-void Plataforma_usuarios::curso_usuario(string u) const
+void Plataforma_usuarios::curso_usuario(const string& u) const
 {
-    cit_u it = Cj_usuarios.find(u);
-    if (it == Cj_usuarios.end()) cout << "error: el usuario no existe" << endl;
-    else cout << it->second.consultar_curso_usuario() << endl;
+    const Usuario* us = buscar(u);
+    if (us == NULL) salida << "error: el usuario no existe" << '\n';
+    else salida << us->consultar_curso_usuario() << '\n';
+}
+
+Usuario* Plataforma_usuarios::buscar(const string& u)
+{
+    unordered_map<string, int>::const_iterator it = posiciones.find(u);
+    if (it == posiciones.end()) return NULL;
+    return &casillas[it->second];
+}
+
+const Usuario* Plataforma_usuarios::buscar(const string& u) const
+{
+    unordered_map<string, int>::const_iterator it = posiciones.find(u);
+    if (it == posiciones.end()) return NULL;
+    return &casillas[it->second];
 }
 
                                                         //Modificadoras
-void Plataforma_usuarios::alta_usuario(string u)
+bool Plataforma_usuarios::anadir(const string& u)
+//una sola busqueda en la tabla: insertamos con casilla -1 y, si el usuario es nuevo, le asignamos la casilla despues
+{
+    pair<unordered_map<string, int>::iterator, bool> nou = posiciones.insert(make_pair(u, -1));
+    if (not nou.second) return false;
+    if (not libres.empty()) { //la casilla libre ya esta vacia (se vacio al dar de baja a su usuario anterior)
+        nou.first->second = libres.back();
+        libres.pop_back();
+    }
+    else {
+        nou.first->second = casillas.size();
+        casillas.push_back(Usuario());
+    }
+    orden.insert(make_pair(&nou.first->first, nou.first->second));
+    return true;
+}
+
+void Plataforma_usuarios::alta_usuario(const string& u)
 {
-    Usuario us;
-    pair<it_u, bool> nou = Cj_usuarios.insert (make_pair(u,us));
-    if (nou.second) cout << Cj_usuarios.size() << endl;
-    else cout << "error: el usuario ya existe" << endl;
+    if (anadir(u)) salida << posiciones.size() << '\n';
+    else salida << "error: el usuario ya existe" << '\n';
 }
 
-void Plataforma_usuarios::baja_usuario(string u, Plataforma_material& pm)
+void Plataforma_usuarios::baja_usuario(const string& u, Plataforma_material& pm)
+//la casilla no se borra: se vacia (conservando su memoria) y queda libre para la siguiente alta
 {
-    it_u it = Cj_usuarios.find(u);
-    if (it == Cj_usuarios.end()) cout << "error: el usuario no existe" << endl;
+    unordered_map<string, int>::iterator it = posiciones.find(u);
+    if (it == posiciones.end()) salida << "error: el usuario no existe" << '\n';
     else{
-        int curso = it->second.consultar_curso_usuario();
+        int i = it->second;
+        int curso = casillas[i].consultar_curso_usuario();
+        if (curso != 0) pm.quitar_clasificacion_curso(curso, &it->first, casillas[i].consultar_resueltos_curso(), casillas[i].consultar_envios_curso());
         if (curso != 0) pm.restar_inscritos(curso,false); //le pasamos "false" porque el usuario NO ha completado ningun curso, sino que se da de baja (y deja a medias el curso en el que estaba inscrito)
-        Cj_usuarios.erase(it);
-        cout << Cj_usuarios.size() << endl;
+        casillas[i].reiniciar();
+        libres.push_back(i);
+        orden.erase(&it->first); //antes que la clave de "posiciones", a la que apunta
+        posiciones.erase(it);
+        salida << posiciones.size() << '\n';
     }
 }
 
-void Plataforma_usuarios::inscribir_curso(string u, int c, Plataforma_material& pm)
+void Plataforma_usuarios::inscribir_curso(const string& u, int c, Plataforma_material& pm)
 //coste (Cuadrático en el número de sesiones del curso) * log(M)
 {
-    it_u itu = Cj_usuarios.find(u);
-    if (itu == Cj_usuarios.end()) cout << "error: el usuario no existe" << endl;
-    else if (not pm.esta_curso(c)) cout << "error: el curso no existe" << endl;
-    else if (itu->second.consultar_curso_usuario() != 0) cout << "error: usuario inscrito en otro curso" << endl;
+    unordered_map<string, int>::const_iterator it = posiciones.find(u);
+    Usuario* us = it == posiciones.end() ? NULL : &casillas[it->second];
+    if (us == NULL) salida << "error: el usuario no existe" << '\n';
+    else if (not pm.esta_curso(c)) salida << "error: el curso no existe" << '\n';
+    else if (us->consultar_curso_usuario() != 0) salida << "error: usuario inscrito en otro curso" << '\n';
 
     //el curso y el usuario son correctos: a continuacion modificamos el curso y el usuario
     else {
-        int sesiones = pm.consultar_num_sesiones(c); //busca el Curso (coste constante) y retorna el numero de sesiones que tiene
-        for (int i = 1; i <= sesiones; ++i) {
-            const Sesion& s_i = pm.indicador_sesion(c,i); //busca cual es la sesion numero "i" dentro del curso c, y retorna la Sesion en s_i
-            s_i.actualizar_enviables_iniciales(itu->second); // va a la sesion, desde alli añade a u los enviables que le faltaban
+        vector<const Sesion*> sesiones;
+        pm.consultar_sesiones_curso(c, sesiones);
+        preparar_inscripcion(*us, pm.consultar_curso(c), sesiones);
+        acabar_inscripcion(*us, &it->first, c, pm);
+    }
+}
+
+void Plataforma_usuarios::inscribir_curso_lote(const vector<string>& usuarios, int c, Plataforma_material& pm, int hilos)
+//1. secuencialmente: se busca cada usuario y se eligen los que se van a inscribir (la primera vez que salen, si no estan inscritos en ningun curso)
+//2. en paralelo: se prepara el progreso de los elegidos, con las sesiones del curso buscadas una sola vez; cada usuario lo prepara un solo hilo
+//3. secuencialmente, en el orden del lote: se escribe el resultado de cada inscripcion y se acaba de inscribir a los elegidos
+{
+    int n = usuarios.size();
+    bool existe = pm.esta_curso(c);
+    vector<unordered_map<string, int>::const_iterator> posicion(n);
+    vector<bool> elegido(n, false);
+    vector<Usuario*> preparar;
+    unordered_set<Usuario*> vistos;
+    for (int i = 0; i < n; ++i) {
+        posicion[i] = posiciones.find(usuarios[i]);
+        if (existe and posicion[i] != posiciones.end()) {
+            Usuario* us = &casillas[posicion[i]->second];
+            if (vistos.insert(us).second and us->consultar_curso_usuario() == 0) {
+                elegido[i] = true;
+                preparar.push_back(us);
+            }
+        }
+    }
+
+    if (not preparar.empty()) {
+        vector<const Sesion*> sesiones;
+        pm.consultar_sesiones_curso(c, sesiones);
+        const Curso& curso = pm.consultar_curso(c);
+        atomic<int> siguiente(0);
+        int extra = min(hilos, int(preparar.size())) - 1; //el hilo principal tambien prepara usuarios
+        vector<thread> trabajadores;
+        for (int i = 0; i < extra; ++i) trabajadores.push_back(thread(preparar_inscripciones, ref(preparar), cref(curso), cref(sesiones), &siguiente));
+        preparar_inscripciones(preparar, curso, sesiones, &siguiente);
+        for (int i = 0; i < trabajadores.size(); ++i) trabajadores[i].join();
+    }
+
+    for (int i = 0; i < n; ++i) {
+        salida << "#inscribir_curso " << usuarios[i] << " " << c << '\n';
+        if (posicion[i] == posiciones.end()) salida << "error: el usuario no existe" << '\n';
+        else if (not existe) salida << "error: el curso no existe" << '\n';
+        else {
+            Usuario& us = casillas[posicion[i]->second];
+            if (elegido[i]) acabar_inscripcion(us, &posicion[i]->first, c, pm);
+            else if (us.consultar_curso_usuario() != 0) salida << "error: usuario inscrito en otro curso" << '\n';
+            else salida << pm.modificar_stats_curso(c, true) << '\n'; //ya salio antes en el lote y completo el curso de entrada: volveria a completarlo
+        }
+    }
+}
+
+void Plataforma_usuarios::preparar_inscripcion(Usuario& u, const Curso& curso, const vector<const Sesion*>& sesiones)
+//solo modifica el usuario: asi se puede llamar a la vez desde varios hilos para usuarios distintos
+{
+    u.preparar_curso(curso); //dimensiona el progreso del usuario para los problemas del curso y marca los que ya tenia resueltos
+    if (u.consultar_resueltos_curso() == 0) u.copiar_enviables(curso.consultar_enviables_iniciales()); //no tiene nada resuelto: sus enviables son las raices de las sesiones, ya calculadas
+    else {
+        for (int i = 0; i < sesiones.size(); ++i) {
+            sesiones[i]->actualizar_enviables_iniciales(u, curso.consultar_base_sesion_i(i + 1)); // va a la sesion, desde alli añade a u los enviables que le faltaban
         }
+    }
+}
+
+void Plataforma_usuarios::preparar_inscripciones(vector<Usuario*>& usuarios, const Curso& curso, const vector<const Sesion*>& sesiones, atomic<int>* siguiente)
+{
+    for (int i = (*siguiente)++; i < usuarios.size(); i = (*siguiente)++) preparar_inscripcion(*usuarios[i], curso, sesiones);
+}
 
-        // ahora solo nos queda mirar si el usuario ya tenia todos los problemas del curso resueltos previamente, y actualizar los stats del curso en funcion de esto
-        bool completado = itu->second.ha_completado_curso();
-        if (not completado) itu->second.inscribir_usuario(c);
-        cout << pm.modificar_stats_curso(c, completado) << endl; //accede al curso, y lo modifica
+void Plataforma_usuarios::acabar_inscripcion(Usuario& us, const string* id, int c, Plataforma_material& pm)
+// ahora solo nos queda mirar si el usuario ya tenia todos los problemas del curso resueltos previamente, y actualizar los stats del curso en funcion de esto
+{
+    bool completado = us.ha_completado_curso();
+    if (not completado) {
+        us.inscribir_usuario(c);
+        pm.anadir_clasificacion_curso(c, id, us.consultar_resueltos_curso(), us.consultar_envios_curso());
     }
+    else us.desinscribir(); //no llega a quedar inscrito: liberamos el progreso que habiamos preparado
+    salida << pm.modificar_stats_curso(c, completado) << '\n'; //accede al curso, y lo modifica
 }
 
-void Plataforma_usuarios::envio(string u, string p, bool r, Plataforma_material& pm)
-//coste (logM) * (logP) * (log (número de problemas del curso)) * (número de problemas de la sesión) * (log (núm prob sesión))
+void Plataforma_usuarios::envio(const string& u, const string& p, bool r, Plataforma_material& pm)
+//coste (logM) * (log (número de problemas del curso)) * (número de problemas de la sesión) * (log (núm prob sesión))
 {
-    it_u it = Cj_usuarios.find(u);
-    it->second.actualizar_problemas(p, r); //busca el problema enviable dentro del usuario u y hace las actualizaciones necesarias
-    pm.actualizar_problema_plataforma(p, r);
+    int ip = pm.consultar_indice_problema(p); //a partir de aqui trabajamos con el indice del problema
+    unordered_map<string, int>::const_iterator it = posiciones.find(u);
+    Curso::Envio e;
+    int curso = aplicar_envio(casillas[it->second], &it->first, ip, r, pm, e);
+    pm.actualizar_problema_plataforma(ip, r);
     //busca el problema en pm y actualiza los stats del problema
+    pm.anotar_envio_curso(e); //y los del problema dentro del curso, y la clasificacion
+    if (curso != 0) pm.restar_inscritos(curso, true); //busca el curs (coste constante) i l'actualitza
+}
+
+void Plataforma_usuarios::envio_diferido(const string& u, const string& p, bool r, const Plataforma_material& pm, Contadores_envios& cambios)
+//igual que envio, pero lo que envio suma a pm se anota en los contadores del hilo: asi se puede llamar a la vez desde varios hilos para usuarios distintos
+{
+    int ip = pm.consultar_indice_problema(p);
+    unordered_map<string, int>::const_iterator it = posiciones.find(u);
+    Curso::Envio e;
+    int curso = aplicar_envio(casillas[it->second], &it->first, ip, r, pm, e);
+    cambios.anotar_envio(ip, r);
+    cambios.anotar_envio_curso(e);
+    if (curso != 0) cambios.anotar_curso_completado(curso);
+}
+
+int Plataforma_usuarios::fragmento_usuario(const string& u, int n)
+{
+    return hash<string>()(u) % n;
+}
+
+int Plataforma_usuarios::aplicar_envio(Usuario& u, const string* id, int ip, bool r, const Plataforma_material& pm, Curso::Envio& e)
+//solo modifica el usuario: asi se puede llamar a la vez desde varios hilos para usuarios distintos
+//lo que hay que anotar en el curso se deja en e, para que quien llama lo anote en pm o en sus contadores
+{
+    Curso::Ubicacion ub;
+    e.curso = u.consultar_curso_usuario();
+    const Sesion& s_i = pm.indicador_sesion2(e.curso, ip, ub); // devuelve la sesion y la ubicacion del problema dentro del curso (coste constante)
+    e.local = ub.local;
+    e.correcto = r;
+    e.primer_intento = u.actualizar_problemas(ip, ub.local, r); //actualiza el progreso del usuario en la posicion local del problema
+    e.usuario = id;
+    e.resueltos = u.consultar_resueltos_curso();
+    e.envios = u.consultar_envios_curso();
     if (r) {
-        const Sesion& s_i = pm.indicador_sesion2(it->second.consultar_curso_usuario(), p); // devuelve la sesion (coste constante)
-        s_i.actualizar_enviables(it->second, p); //es un metodo de Sesion que modifica los enviables del usuario
-        bool completado = it->second.ha_completado_curso();
-        if (completado) {
-          int curso = it->second.desinscribir();
-          pm.restar_inscritos(curso, completado); //busca el curs (coste constante) i l'actualitza
+        s_i.actualizar_enviables(u, ub.nodo, ub.local - ub.nodo); //es un metodo de Sesion que modifica los enviables del usuario, empezando directamente por el nodo del problema
+        if (u.ha_completado_curso()) return u.desinscribir();
+    }
+    return 0;
+}
+
+void Plataforma_usuarios::envios_lote(const vector<Envio>& lote, Plataforma_material& pm, int hilos)
+//1. secuencialmente: se busca cada usuario y cada problema, se agrupan los envios por usuario (en el orden del lote) y se cuentan los envios de cada problema, que no dependen del orden
+//2. en paralelo: cada grupo lo aplica entero un solo hilo, y los hilos van cogiendo grupos de un contador compartido (asi un usuario con muchos envios no deja parados a los demas)
+//3. secuencialmente: se suman a pm los envios de cada problema y los cursos completados
+{
+    vector<Grupo_envios> grupos;
+    unordered_map<Usuario*, int> grupo_usuario;
+    Contadores_envios cambios;
+    for (int i = 0; i < lote.size(); ++i) {
+        unordered_map<string, int>::const_iterator it = posiciones.find(lote[i].usuario);
+        Usuario* u = &casillas[it->second];
+        int ip = pm.consultar_indice_problema(lote[i].problema);
+        pair<unordered_map<Usuario*, int>::iterator, bool> nou = grupo_usuario.insert(make_pair(u, int(grupos.size())));
+        if (nou.second) {
+            grupos.push_back(Grupo_envios());
+            grupos.back().usuario = u;
+            grupos.back().id = &it->first;
+            grupos.back().curso_completado = 0;
+        }
+        grupos[nou.first->second].envios.push_back(make_pair(ip, lote[i].correcto));
+        cambios.anotar_envio(ip, lote[i].correcto);
+    }
+
+    atomic<int> siguiente(0);
+    int extra = min(hilos, int(grupos.size())) - 1; //el hilo principal tambien aplica grupos
+    vector<thread> trabajadores;
+    for (int i = 0; i < extra; ++i) trabajadores.push_back(thread(aplicar_grupos, ref(grupos), cref(pm), &siguiente));
+    aplicar_grupos(grupos, pm, &siguiente);
+    for (int i = 0; i < trabajadores.size(); ++i) trabajadores[i].join();
+
+    for (int i = 0; i < grupos.size(); ++i) {
+        for (int k = 0; k < grupos[i].envios_curso.size(); ++k) cambios.anotar_envio_curso(grupos[i].envios_curso[k]);
+        if (grupos[i].curso_completado != 0) cambios.anotar_curso_completado(grupos[i].curso_completado);
+    }
+    cambios.aplicar(pm);
+}
+
+void Plataforma_usuarios::aplicar_grupos(vector<Grupo_envios>& grupos, const Plataforma_material& pm, atomic<int>* siguiente)
+{
+    for (int g = (*siguiente)++; g < grupos.size(); g = (*siguiente)++) {
+        Grupo_envios& grupo = grupos[g];
+        grupo.envios_curso.resize(grupo.envios.size());
+        for (int i = 0; i < grupo.envios.size(); ++i) {
+            int curso = aplicar_envio(*grupo.usuario, grupo.id, grupo.envios[i].first, grupo.envios[i].second, pm, grupo.envios_curso[i]);
+            if (curso != 0) grupo.curso_completado = curso; //como el lote solo tiene envios, cada usuario puede completar como mucho un curso
         }
     }
 }
@@ -86,46 +266,96 @@ void Plataforma_usuarios::envio(string u, string p, bool r, Plataforma_material&
 void Plataforma_usuarios::leer_cj_usuarios() //OK
 //lee un entero M seguido de M usuarios, que pasan a formar parte de la plataforma
 {
-  int M; cin >> M;
-  Usuario u;
+  int M; entrada >> M;
+  casillas.reserve(casillas.size() + M);
   string id;
   for (int i = 0; i < M; ++i) {
-      cin >> id;
-      Cj_usuarios.insert(make_pair(id,u));
+      entrada >> id;
+      anadir(id);
   }
 }
 
 void Plataforma_usuarios::listar_usuarios() const
+//la tabla de dispersion no esta ordenada: recorremos el indice ordenado
 {
-  for (cit_u it = Cj_usuarios.begin(); it != Cj_usuarios.end(); ++it) {
-    cout << it->first;
-    it->second.escribir_usuario();
+  for (Indice_usuarios::const_iterator it = orden.begin(); it != orden.end(); ++it) {
+    salida << *it->first;
+    casillas[it->second].escribir_usuario();
   }
 }
 
-void Plataforma_usuarios::escribir_usuario(string u) const
+void Plataforma_usuarios::listar_usuarios_pagina(const string& desde, int n) const
 {
-  cit_u it = Cj_usuarios.find(u);
-  if (it == Cj_usuarios.end()) cout << "error: el usuario no existe" << endl;
+  Indice_usuarios::const_iterator it = desde == DESDE_INICIO ? orden.begin() : orden.lower_bound(&desde);
+  for (int i = 0; i < n and it != orden.end(); ++i, ++it) {
+    salida << *it->first;
+    casillas[it->second].escribir_usuario();
+  }
+  if (it != orden.end()) salida << "siguiente " << *it->first << '\n';
+}
+
+void Plataforma_usuarios::buscar_usuarios(const string& prefijo, int n) const
+//los identificadores que empiezan por el prefijo son consecutivos en el indice ordenado, y el primero es el primero que no es menor que el prefijo
+{
+  Indice_usuarios::const_iterator it = orden.lower_bound(&prefijo);
+  for (int i = 0; i < n and it != orden.end() and it->first->compare(0, prefijo.size(), prefijo) == 0; ++i, ++it) {
+    salida << *it->first;
+    casillas[it->second].escribir_usuario();
+  }
+}
+
+void Plataforma_usuarios::escribir_usuario(const string& u) const
+{
+  const Usuario* us = buscar(u);
+  if (us == NULL) salida << "error: el usuario no existe" << '\n';
   else {
-    cout << it->first;
-    it->second.escribir_usuario();
+    salida << u;
+    us->escribir_usuario();
   }
 }
 
 
-void Plataforma_usuarios::problemas_resueltos(string u) const
+void Plataforma_usuarios::problemas_resueltos(const string& u, const Plataforma_material& pm) const
 {
-  cit_u it = Cj_usuarios.find(u);
-  if (it == Cj_usuarios.end()) cout << "error: el usuario no existe" << endl;
-  else it->second.escribir_problemas_verdes_usuario();
+  const Usuario* us = buscar(u);
+  if (us == NULL) salida << "error: el usuario no existe" << '\n';
+  else us->escribir_problemas_verdes_usuario(pm.consultar_ids_problemas());
 
 }
 
-void Plataforma_usuarios::problemas_enviables(string u) const
+void Plataforma_usuarios::problemas_enviables(const string& u, const Plataforma_material& pm) const
 {
-  cit_u it = Cj_usuarios.find(u);
-  if (it == Cj_usuarios.end()) cout << "error: el usuario no existe" << endl;
-  else if (it->second.consultar_curso_usuario() == 0) cout << "error: usuario no inscrito en ningun curso" << endl;
-  else it->second.escribir_problemas_enviables_usuario();
+  const Usuario* us = buscar(u);
+  if (us == NULL) salida << "error: el usuario no existe" << '\n';
+  else if (us->consultar_curso_usuario() == 0) salida << "error: usuario no inscrito en ningun curso" << '\n';
+  else us->escribir_problemas_enviables_usuario(pm.consultar_curso(us->consultar_curso_usuario()), pm.consultar_ids_problemas());
+}
+
+                                                     //Lectura y escritura en formato binario
+void Plataforma_usuarios::guardar(Escritor_binario& f) const
+//por orden de identificador: el formato no depende de las casillas
+{
+  f.escribir_entero(orden.size());
+  for (Indice_usuarios::const_iterator it = orden.begin(); it != orden.end(); ++it) {
+    f.escribir_string(*it->first);
+    casillas[it->second].guardar(f);
+  }
+}
+
+void Plataforma_usuarios::cargar(Lector_binario& f, Plataforma_material& pm)
+//la clasificacion de los cursos no se guarda (apunta a los identificadores): se reconstruye a medida que se cargan los usuarios
+{
+  int M = f.leer_cantidad(6*sizeof(int));
+  casillas.reserve(M);
+  for (int i = 0; i < M and not f.fallo(); ++i) {
+    string id = f.leer_string();
+    anadir(id);
+    unordered_map<string, int>::const_iterator it = posiciones.find(id);
+    Usuario& u = casillas[it->second];
+    u.cargar(f);
+    int c = u.consultar_curso_usuario();
+    if (c != 0 and not f.fallo()) {
+      pm.anadir_clasificacion_curso(c, &it->first, u.consultar_resueltos_curso(), u.consultar_envios_curso());
+    }
+  }
 }
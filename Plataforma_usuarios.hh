@@ -7,6 +7,17 @@
 
 #include "Plataforma_material.hh"
 #include "Usuario.hh"
+#include "Contadores.hh"
+
+#ifndef NO_DIAGRAM
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <functional>
+#endif
 
 
 /** @class Plataforma_usuarios
@@ -14,7 +25,13 @@
 
     La información de la Plataforma de usuarios viene dada por una estructura que contiene todos los Usuarios, donde cada uno está asociado a un identificador distinto.
 
-    Las operaciones son: consultora del curso en el que está inscrito un usuario dado, lectura de un conjunto de usuarios (para inicializar la plataforma), escritura de todo el conjunto de usuarios, escritura de un usuario dado, escritura de los problemas enviables de un usuario dado, escritura de los problemas correctos de un usuario dado. Las operaciones modificadoras son: dar de alta un usuario nuevo, dar de baja un usuario existente, inscribir un usuario existente en un curso dado, qu un usuario realice un envio de uno de sus problemas enviables.
+    Cada usuario ocupa una casilla fija de un vector, y una tabla de dispersión da la casilla de cada identificador, así que buscar un usuario cuesta tiempo constante en media. Al dar de baja un usuario su casilla queda libre y la siguiente alta la reaprovecha tal como está: el usuario se vacía pero conserva la memoria que tenía reservada (ver Usuario::reiniciar), de manera que las altas y bajas frecuentes no reservan ni liberan memoria. Como el vector no está ordenado, los identificadores se guardan también en un índice ordenado, que es el que se recorre para escribir o guardar todos los usuarios por orden.
+
+    Las operaciones son: consultora del curso en el que está inscrito un usuario dado, lectura de un conjunto de usuarios (para inicializar la plataforma), escritura de todo el conjunto de usuarios, escritura de un usuario dado, escritura de los problemas enviables de un usuario dado, escritura de los problemas correctos de un usuario dado. Las operaciones modificadoras son: dar de alta un usuario nuevo, dar de baja un usuario existente, inscribir un usuario existente en un curso dado, qu un usuario realice un envio de uno de sus problemas enviables, y aplicar un lote de envíos de golpe.
+
+    Los lotes de envíos se agrupan por usuario (manteniendo el orden de los envíos de cada usuario) y los grupos se reparten entre varios hilos: los usuarios son independientes entre sí y la plataforma de material solo se consulta mientras tanto. Los envíos a cada problema y los cursos completados se suman a la plataforma de material al final, de manera que el resultado es el mismo que el de aplicar los envíos uno a uno.
+
+    Para ejecutar funcionalidades en paralelo, los usuarios se reparten en fragmentos según su identificador, y cada fragmento lo trata un solo hilo. Mientras tanto el conjunto de usuarios no cambia de forma (no hay altas ni bajas), así que cada hilo puede buscar sus usuarios sin bloquear a los demás. Los envíos hechos así no tocan la plataforma de material: anotan los cambios que le corresponden en los contadores del hilo (Contadores_envios), que se aplican después.
 
 */
 
@@ -22,8 +39,41 @@ class Plataforma_usuarios
 {
 
 private:
-      /** @brief Estructura que contiene todos los usuarios inscritos actualmente en la plataforma */
-      map<string, Usuario> Cj_usuarios;
+      /** @brief Compara dos identificadores a partir de punteros a ellos */
+      struct Menor_id {
+            bool operator()(const string* a, const string* b) const { return *a < *b; }
+      };
+
+      /** @brief Índice ordenado de identificadores (punteros a ellos) con su casilla */
+      typedef map<const string*, int, Menor_id, Asignador_pool< pair<const string* const, int> > > Indice_usuarios;
+
+      /** @brief Casillas de los usuarios (las de los usuarios dados de baja están vacías y en "libres") */
+      vector<Usuario> casillas;
+      /** @brief Casillas vacías, que se reaprovechan en las próximas altas */
+      vector<int> libres;
+      /** @brief Casilla de cada usuario de la plataforma, por identificador */
+      unordered_map<string, int> posiciones;
+      /** @brief Pool del que se reservan los nodos de "orden" (tiene que construirse antes y destruirse después que él) */
+      Pool pool_orden;
+      /** @brief Índice ordenado de los usuarios: identificador (apunta a la clave de "posiciones", que no se mueve) y casilla. Los nodos se reservan de pool_orden (ver Asignador_pool) */
+      Indice_usuarios orden;
+
+      /** @brief Envíos de un lote que hace un mismo usuario (con su identificador), con el índice del problema y si es correcto), en el orden del lote, lo que hay que anotar de cada uno en su curso, y curso que ha completado con ellos (0 si no ha completado ninguno) */
+      struct Grupo_envios {
+            Usuario* usuario;
+            const string* id;
+            vector< pair<int,bool> > envios;
+            vector<Curso::Envio> envios_curso;
+            int curso_completado;
+      };
+
+public:
+      /** @brief Envío de un lote: identificador del usuario, identificador del problema y si es correcto */
+      struct Envio {
+            string usuario;
+            string problema;
+            bool correcto;
+      };
 
 public:
       //Constructora
@@ -39,36 +89,64 @@ public:
       /** @brief Consulta en qué curso está inscrito un usuario
         \pre u es el identifcador del usuario
         \post Si el usuario no exite en la plataforma, salta un error. Si existe, se imprime un 0 si no está en ningún curso, o el identificador del curso (si está en alguno)
-        \coste Logarítmico en M (número de usuarios)
+        \coste Constante (en media)
       */
-      void curso_usuario(string u) const;
+      void curso_usuario(const string& u) const;
 
       //Modificadoras
       /** @brief Operación de dar de alta un usuario
         \pre u contiene el nombre de usuario que se desea dar de alta
-        \post Se comprueba si el nombre u ya existe en la plataforma. Si está, salta un error. Si no está, se añade el usuario a la plataforma y se imprime el número total de usuarios después de añadirlo
-        \coste Logarítmico en M (número de usuarios)
+        \post Se comprueba si el nombre u ya existe en la plataforma. Si está, salta un error. Si no está, se añade el usuario a la plataforma (en una casilla libre, si hay alguna) y se imprime el número total de usuarios después de añadirlo
+        \coste Logarítmico en M (número de usuarios), por el índice ordenado
       */
-      void alta_usuario(string u);
+      void alta_usuario(const string& u);
 
       /** @brief Operación de dar de baja un usuario
         \pre u contiene el nombre de usuario que se desea dar de baja, pm es la plataforma de material que contiene la información sobre problemas, sesiones y cursos
-        \post Se comprueba si el usuario u existe en la plataforma. Si no está, salta un error. Si está, se elimina de la plataforma, se modifica el curso en cuestión (para desinscribir un usuario) y se imprime el número total de usuarios después de borrarlo
-        \coste Logarítmico en M (número de usuarios)
+        \post Se comprueba si el usuario u existe en la plataforma. Si no está, salta un error. Si está, se elimina de la plataforma (su casilla se vacía y queda libre), se modifica el curso en cuestión (para desinscribir un usuario y quitarlo de la clasificación) y se imprime el número total de usuarios después de borrarlo
+        \coste Logarítmico en M (número de usuarios), por el índice ordenado, más lineal en el número de problemas verdes del usuario
       */
-      void baja_usuario(string u, Plataforma_material& pm);
+      void baja_usuario(const string& u, Plataforma_material& pm);
 
       /** @brief Operación de inscribir un usuario en un curso
         \pre c es el identificador de un curso, u es el nombre de usuario que desea inscribirse en el curso c, pm es la plataforma de material que contiene la información sobre problemas, sesiones y cursos
-        \post Se comprueba si el usuario existe. Si no existe, salta un error. A continuación se comprueba si el curso existe en la plataforma pm, si no existe salta un error. También se comprueba si u está inscrito en algún curso. Si lo está, salta un error. En caso contrario, se modifica c (que pertenece a pm) para inscribir el usuario u a c, e imprime el número de usuarios inscritos en c. Además, después de modificar el curso (de Plataforma_material) también modifica el parámetro implícito inscribiéndolo al curso en cuestión y actualizando su historial de "enviables"
+        \post Se comprueba si el usuario existe. Si no existe, salta un error. A continuación se comprueba si el curso existe en la plataforma pm, si no existe salta un error. También se comprueba si u está inscrito en algún curso. Si lo está, salta un error. En caso contrario, se modifica c (que pertenece a pm) para inscribir el usuario u a c, e imprime el número de usuarios inscritos en c (y, si no lo ha completado de entrada, se añade u a la clasificación de c). Además, después de modificar el curso (de Plataforma_material) también modifica el parámetro implícito inscribiéndolo al curso en cuestión y actualizando su historial de "enviables"
       */
-      void inscribir_curso(string u, int c, Plataforma_material& pm);
+      void inscribir_curso(const string& u, int c, Plataforma_material& pm);
+
+      /** @brief Operación de inscribir un lote de usuarios en un curso
+        \pre c es el identificador de un curso, usuarios contiene los nombres de los usuarios que se desean inscribir en el curso c (en orden), pm es la plataforma de material que contiene la información sobre problemas, sesiones y cursos; hilos >= 1
+        \post El parámetro implícito y pm quedan igual que si se hubiera hecho inscribir_curso de cada usuario del lote, en orden, y para cada uno se ha escrito "#inscribir_curso", el usuario y el curso, seguido del mismo resultado que inscribir_curso. Las sesiones del curso se buscan una sola vez, y el progreso inicial de los usuarios se ha calculado usando como mucho "hilos" hilos
+        \coste Lineal en el tamaño del lote por el coste de preparar el progreso de un usuario, repartido entre los hilos, más el logaritmo de M por cada usuario
+      */
+      void inscribir_curso_lote(const vector<string>& usuarios, int c, Plataforma_material& pm, int hilos);
 
       /** @brief Operación de procesar un envío
         \pre u es el identificador del usuario que realiza el envío; pm es la plataforma de material que contiene la información sobre problemas, sesiones y cursos; p es el identifcador del problema que envía. r vale 1 si el problema se resuelve con éxito, 0 si no
-        \post Se suma uno al número de envíos totales del usuario u. Se suma uno al número de envíos totales del problema p. Si u tiene 0 envíos para el problema p (esto lo podemos hacer porque tenemos garantizado que está entre los enviables de u), se suma uno al recuento de intentados de u. Si tenía un intento o más, se suma uno al número de envíos para ese problema intentado. Si r es 0, no se hace nada más. Si r es 1: 1. se suma uno al número de envíos correctos del problema p. 2. Se elimina la pareja "problema, número de envíos" del historial de "enviables" del usuario, y se añade la misma al historial de problemas verdes del usuario. Además, se añade al historial de "enviables" el/los problemas de los cuales el problema que acaba de resolver era prerrequisito. Por último, si el historial de "enviables" de u ha quedado vacío (es decir, se ha completado el curso), se desinscribe el usuario del curso y se resta uno al número de usuarios inscritos en el curso
+        \post Se suma uno al número de envíos totales del usuario u. Se suma uno al número de envíos totales del problema p. Si u tiene 0 envíos para el problema p (esto lo podemos hacer porque tenemos garantizado que está entre los enviables de u), se suma uno al recuento de intentados de u. Si tenía un intento o más, se suma uno al número de envíos para ese problema intentado. Si r es 0, no se hace nada más. Si r es 1: 1. se suma uno al número de envíos correctos del problema p. 2. Se elimina la pareja "problema, número de envíos" del historial de "enviables" del usuario, y se añade la misma al historial de problemas verdes del usuario. Además, se añade al historial de "enviables" el/los problemas de los cuales el problema que acaba de resolver era prerrequisito. Por último, si el historial de "enviables" de u ha quedado vacío (es decir, se ha completado el curso), se desinscribe el usuario del curso y se resta uno al número de usuarios inscritos en el curso. En todos los casos se actualiza el puesto de u en la clasificación del curso (o se le quita de ella, si lo ha completado)
+      */
+      void envio(const string& u, const string& p, bool r, Plataforma_material& pm);
+
+      /** @brief Operación de procesar un lote de envíos
+        \pre Cada envío del lote cumple la precondición de envio si se aplican en orden; pm es la plataforma de material que contiene la información sobre problemas, sesiones y cursos; hilos >= 1
+        \post El parámetro implícito y pm quedan igual que si se hubiera hecho envio de cada envío del lote, en orden. Se han utilizado como mucho "hilos" hilos
+        \coste Lineal en el tamaño del lote, repartido entre los hilos
+      */
+      void envios_lote(const vector<Envio>& lote, Plataforma_material& pm, int hilos);
+
+      /** @brief Operación de procesar un envío sin modificar la plataforma de material
+        \pre Las mismas que envio. Ningún otro hilo está tratando el usuario u ni dando de alta o de baja usuarios
+        \post El usuario u queda igual que con envio, y los cambios que envio habría hecho en pm se han anotado en "cambios"
+        \coste El mismo que envio
       */
-      void envio(string u, string p, bool r, Plataforma_material& pm);
+      void envio_diferido(const string& u, const string& p, bool r, const Plataforma_material& pm, Contadores_envios& cambios);
+
+      /** @brief Consulta a qué fragmento pertenece un usuario
+        \pre n >= 1
+        \post Retorna el fragmento (entre 0 y n-1) al que pertenece el usuario con identificador u cuando los usuarios se reparten en n fragmentos
+        \coste Lineal en la longitud de u
+      */
+      static int fragmento_usuario(const string& u, int n);
 
       //Lectura y escritura
       /** @brief Lectura de un conjunto de usuarios para inicializar la plataforma
@@ -85,25 +163,106 @@ public:
       */
       void listar_usuarios() const;
 
+      /** @brief Escritura de una página de los usuarios de la plataforma
+        \pre desde es DESDE_INICIO o un identificador cualquiera (normalmente, el cursor que ha escrito la página anterior); n >= 0
+        \post Se escriben (como en listar_usuarios) los n primeros usuarios con identificador no menor que desde (desde el primero, si desde es DESDE_INICIO). Si quedan más usuarios detrás, se escribe "siguiente" seguido del identificador del primero que falta, que es el cursor de la página siguiente. Como las páginas se ordenan por identificador, cada usuario que está en la plataforma durante todo el recorrido sale exactamente una vez, aunque entre dos páginas se den de alta o de baja otros usuarios (incluido el del cursor)
+        \coste Logarítmico en M (número de usuarios), más lineal en n
+      */
+      void listar_usuarios_pagina(const string& desde, int n) const;
+
+      /** @brief Escritura de los usuarios con un prefijo dado
+        \pre n >= 0
+        \post Se escriben (como en listar_usuarios, ordenados por identificador) los n primeros usuarios de la plataforma cuyo identificador empieza por "prefijo" (todos, si hay menos de n)
+        \coste Logarítmico en M (número de usuarios), más lineal en el número de usuarios escritos
+      */
+      void buscar_usuarios(const string& prefijo, int n) const;
+
       /** @brief Escritura de un usuario de la plataforma
         \pre u es el identifcador del usuario que se quiere escribir
         \post Si u no está en la plataforma de usuarios, salta un error. Si está, se imprime la información del usuario (número de envíos totales, número de problemas "verdes", número de problemas intentados, identificador del curso en el que está inscrito (si lo está en alguno) o 0 (si no está en ninguno))
-        \coste M * logM
+        \coste Constante (en media)
       */
-      void escribir_usuario(string u) const;
+      void escribir_usuario(const string& u) const;
 
       /** @brief Escritura de todos los problemas correctos de un usuario
-        \pre u es el identificador del usuario
+        \pre u es el identificador del usuario, pm es la plataforma de material que contiene los identificadores de los problemas
         \post Se comprueba si el usuario existe en la plataforma. Si no existe, salta un error. Si existe, se imprimen los identificadores de los problemas realizados con éxito, y el número de envíos totales que u ha hecho a cada problema
-        \coste (Número de problemas resueltos de u) * logM
+        \coste n*log(n), n = número de problemas resueltos de u
       */
-      void problemas_resueltos(string u) const;
+      void problemas_resueltos(const string& u, const Plataforma_material& pm) const;
 
       /** @brief Escritura de los problemas enviables de un usuario
-        \pre u es el identificador del usuario
+        \pre u es el identificador del usuario, pm es la plataforma de material que contiene los identificadores de los problemas
         \post Si u no existe en la plataforma, salta un error. Si u no está inscrito en ningún curso, salta un error. Si no, se escriben todos los problemas que u tiene enviados sin éxito (o sin enviar) pero tiene todos los problemas prerrequisito resueltos, es decir, todos los enviables
-        \coste (Número de problemas resueltos de u) * logM
+        \coste Lineal en el número de problemas del curso más n*log(n), n = número de problemas enviables de u
+      */
+      void problemas_enviables(const string& u, const Plataforma_material& pm) const;
+
+      //Lectura y escritura en formato binario
+      /** @brief Escritura de la plataforma de usuarios en formato binario
+        \pre f es un fichero binario abierto para escritura
+        \post Se han escrito en f todos los usuarios de la plataforma (identificador, stats, curso, enviables y verdes)
+        \coste Lineal en el tamaño de la plataforma
+      */
+      void guardar(Escritor_binario& f) const;
+
+      /** @brief Lectura de la plataforma de usuarios en formato binario
+        \pre El parámetro implícito está vacío. En la posición actual de f hay una plataforma escrita con guardar, y pm es la plataforma de material que se guardó con ella (ya cargada)
+        \post El parámetro implícito pasa a tener el contenido leído de f, y cada usuario inscrito en un curso se ha añadido a la clasificación del curso en pm
+      */
+      void cargar(Lector_binario& f, Plataforma_material& pm);
+
+private:
+      /** @brief Aplica un envío a un usuario, sin modificar la plataforma de material
+        \pre u está inscrito en un curso de pm, id apunta a su identificador, y ip es el índice de uno de sus problemas enviables, r indica si el envío es correcto
+        \post Se han hecho en u las modificaciones de envio, y e contiene lo que hay que anotar del envío en el curso de u. Si con el envío u ha completado el curso, se le ha desinscrito y se retorna el curso; si no, se retorna 0
+        \coste Lineal en el número de problemas desbloqueados, más el logaritmo del número de problemas resueltos por u
+      */
+      static int aplicar_envio(Usuario& u, const string* id, int ip, bool r, const Plataforma_material& pm, Curso::Envio& e);
+
+      /** @brief Prepara el progreso de un usuario que se inscribe en un curso
+        \pre u no está inscrito en ningún curso, sesiones contiene las sesiones de "curso" (ver Plataforma_material::consultar_sesiones_curso)
+        \post u tiene el progreso preparado para "curso" (ver Usuario::preparar_curso) y todos sus enviables iniciales, pero todavía no está inscrito. Si u no tiene resuelto ningún problema del curso, los enviables se copian de los que el curso tiene calculados, sin recorrer los árboles de las sesiones
+        \coste Lineal en el número de problemas del curso más el número de problemas resueltos por u
+      */
+      static void preparar_inscripcion(Usuario& u, const Curso& curso, const vector<const Sesion*>& sesiones);
+
+      /** @brief Acaba de inscribir un usuario en un curso
+        \pre us tiene el progreso preparado para el curso c de pm (con preparar_inscripcion) e id apunta a su identificador
+        \post Si us tiene resueltos todos los problemas de c, se ha liberado su progreso y se ha contado como completado en c; si no, us está inscrito en c y en su clasificación. Se ha escrito el número de usuarios inscritos en c
+        \coste Logarítmico en el número de usuarios inscritos en c
       */
-      void problemas_enviables(string u) const;
+      static void acabar_inscripcion(Usuario& us, const string* id, int c, Plataforma_material& pm);
+
+      /** @brief Prepara inscripciones mientras queden
+        \pre siguiente apunta al contador compartido del siguiente usuario por preparar; cada usuario de "usuarios" cumple la precondición de preparar_inscripcion y sale una sola vez
+        \post Se ha hecho preparar_inscripcion de cada usuario obtenido del contador, hasta que no quedan usuarios
+      */
+      static void preparar_inscripciones(vector<Usuario*>& usuarios, const Curso& curso, const vector<const Sesion*>& sesiones, atomic<int>* siguiente);
+
+      /** @brief Aplica grupos de envíos mientras queden
+        \pre siguiente apunta al contador compartido del siguiente grupo por aplicar
+        \post Se han aplicado (con aplicar_envio y en orden) los envíos de cada grupo obtenido del contador, hasta que no quedan grupos, y se ha anotado en cada grupo lo que hay que anotar de sus envíos en el curso y el curso que ha completado
+      */
+      static void aplicar_grupos(vector<Grupo_envios>& grupos, const Plataforma_material& pm, atomic<int>* siguiente);
+
+      /** @brief Busca un usuario
+        \pre <em>cierto</em>
+        \post Retorna un puntero al usuario con identificador u, o NULL si no está en la plataforma
+        \coste Constante (en media)
+      */
+      Usuario* buscar(const string& u);
+      const Usuario* buscar(const string& u) const;
+
+      /** @brief Añade un usuario nuevo
+        \pre <em>cierto</em>
+        \post Si u ya estaba en la plataforma, retorna false y no se ha modificado nada. Si no, retorna true y se ha añadido u (vacío) en una casilla libre o, si no hay ninguna, en una nueva
+        \coste Logarítmico en M (número de usuarios)
+      */
+      bool anadir(const string& u);
+
+      /** @brief Las plataformas no se pueden copiar (la copia de "orden" reservaría del pool del original) */
+      Plataforma_usuarios(const Plataforma_usuarios&);
+      Plataforma_usuarios& operator=(const Plataforma_usuarios&);
 };
 #endif
@@ -22,8 +22,25 @@ void Problema::anadir_envio_total_problema() {
 void Problema::anadir_envio_correcto_problema() {
     ++envios_correctos;
 }
+
+void Problema::anadir_envios_problema(int totales, int correctos) {
+    envios_totales += totales;
+    envios_correctos += correctos;
+}
+                                                    //Lectura y escritura en formato binario
+void Problema::guardar(Escritor_binario& f) const
+{
+    f.escribir_entero(envios_totales);
+    f.escribir_entero(envios_correctos);
+}
+
+void Problema::cargar(Lector_binario& f)
+{
+    envios_totales = f.leer_entero();
+    envios_correctos = f.leer_entero();
+}
                                                     //Escritura
 void Problema::escribir_problema() const
 {
-    cout << "(" << envios_totales << "," << envios_correctos << "," << this->consultar_ratio() << ")" << endl;
+    salida << "(" << envios_totales << "," << envios_correctos << "," << this->consultar_ratio() << ")" << '\n';
 }
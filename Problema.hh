@@ -9,12 +9,15 @@
 using namespace std;
 #endif
 
+#include "Escritor.hh"
+#include "Binario.hh"
+
 /** @class Problema
     @brief Representa la información y las operaciones asociadas a un problema.
 
      La información de un problema viene dada por el número de envíos totales al problema, y por el número de envíos correctos que se le han hecho
 
-     Las operaciones son: la consultora de la ratio, las modificadoras de añadir un envio total y un envio correcto, y la escritura de un problema.
+     Las operaciones son: la consultora de la ratio, las modificadoras de añadir un envio total, un envio correcto o varios envíos de golpe, y la escritura de un problema.
 
 */
 
@@ -59,6 +62,13 @@ public:
     */
     void anadir_envio_correcto_problema();
 
+    /** @brief Añade varios envíos de golpe
+        \pre 0 <= correctos <= totales
+        \post Se han añadido en el parámetro implícito "totales" envíos más al número total de envíos, de los cuales "correctos" al número de envíos correctos
+        \coste Constante
+    */
+    void anadir_envios_problema(int totales, int correctos);
+
 
                                                     //Escritura
     /** @brief Operación de escritura de un problema
@@ -67,5 +77,20 @@ public:
         \coste Constante
     */
     void escribir_problema() const;
+
+    //Lectura y escritura en formato binario
+    /** @brief Escritura de un problema en formato binario
+        \pre f es un fichero binario abierto para escritura
+        \post Se ha escrito en f el contenido del parámetro implícito
+        \coste Constante
+    */
+    void guardar(Escritor_binario& f) const;
+
+    /** @brief Lectura de un problema en formato binario
+        \pre En la posición actual de f hay un contenido escrito con guardar
+        \post El parámetro implícito pasa a tener el contenido leído de f
+        \coste Constante
+    */
+    void cargar(Lector_binario& f);
 };
 #endif
@@ -0,0 +1,138 @@
+/** @file Registro.cc
+    @brief Implementación de la clase Registro
+*/
+#include "Registro.hh"
+
+#ifndef NO_DIAGRAM
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+                                                    //Constructora y destructora
+Registro::Registro(int lote)
+{
+    fd = -1;
+    sin_confirmar = 0;
+    this->lote = lote;
+    lsn = 0;
+}
+
+Registro::~Registro()
+{
+    if (fd != -1) {
+        confirmar();
+        close(fd);
+    }
+}
+                                                    //Consultoras
+long long Registro::consultar_lsn() const
+{
+    return lsn;
+}
+                                                    //Modificadoras
+bool Registro::abrir(const string& nombre, long long desde, vector<string>& comandos)
+//recorre las anotaciones del fichero hasta la primera que este incompleta o corrupta
+{
+    long long valido = 0; //bytes del fichero que contienen anotaciones validas
+    {
+        Fichero_proyectado fichero;
+        if (fichero.abrir(nombre)) {
+            Lector_binario f(fichero.consultar_datos(), fichero.consultar_mida());
+            bool ok = true;
+            while (ok) {
+                int n = f.leer_cantidad(1); //una longitud corrupta no puede hacer reservar mas memoria que el tamano del fichero
+                long long l = f.leer_entero_largo();
+                string texto;
+                if (not f.fallo() and n > 0) {
+                    vector<char> aux(n);
+                    f.leer_bytes(&aux[0], n);
+                    texto.assign(aux.begin(), aux.end());
+                }
+                unsigned int s = f.leer_entero();
+                ok = not f.fallo() and n >= 0 and s == suma_comprobacion(texto.data(), texto.size(), suma_comprobacion((const char*)&l, sizeof(l)));
+                if (ok) {
+                    if (l >= desde) comandos.push_back(texto);
+                    lsn = l + 1;
+                    valido += sizeof(int) + sizeof(long long) + n + sizeof(int);
+                }
+            }
+        }
+    }
+    if (lsn < desde) lsn = desde; //el registro puede ser mas nuevo que el estado del que partimos
+    this->nombre = nombre;
+    fd = open(nombre.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd == -1) return false;
+    if (ftruncate(fd, valido) != 0 or lseek(fd, valido, SEEK_SET) != valido) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool Registro::anotar(const string& comando)
+{
+    lock_guard<mutex> cerrado(m);
+    int n = comando.size();
+    unsigned int s = suma_comprobacion(comando.data(), n, suma_comprobacion((const char*)&lsn, sizeof(lsn)));
+    int mida = pendientes.size();
+    pendientes.resize(mida + sizeof(n) + sizeof(lsn) + n + sizeof(s));
+    char* p = &pendientes[mida];
+    memcpy(p, &n, sizeof(n)); p += sizeof(n);
+    memcpy(p, &lsn, sizeof(lsn)); p += sizeof(lsn);
+    memcpy(p, comando.data(), n); p += n;
+    memcpy(p, &s, sizeof(s));
+    ++lsn;
+    ++sin_confirmar;
+    if (lote > 0 and sin_confirmar >= lote) return escribir_pendientes();
+    return true;
+}
+
+bool Registro::confirmar()
+{
+    lock_guard<mutex> cerrado(m);
+    return escribir_pendientes();
+}
+
+bool Registro::cortar(long long desde)
+//mientras se cambia el fichero nadie puede anotar, asi que ninguna anotacion puede ir a parar al fichero antiguo despues de sustituirlo
+{
+    lock_guard<mutex> cerrado(m);
+    if (fd == -1 or lsn > desde or not escribir_pendientes()) return false;
+    string temporal = nombre + ".tmp";
+    int nuevo = open(temporal.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (nuevo == -1) return false;
+    if (fsync(nuevo) != 0 or rename(temporal.c_str(), nombre.c_str()) != 0) {
+        close(nuevo);
+        unlink(temporal.c_str());
+        return false;
+    }
+    close(fd);
+    fd = nuevo;
+    sincronizar_directorio(nombre); //si el cambio de nombre se pierde, el fichero antiguo sigue siendo un registro correcto
+    return true;
+}
+
+bool Registro::escribir_pendientes()
+//si write falla a medias, se descarta solo lo que ya se ha escrito: el resto se escribira detras en el siguiente intento, y el fichero queda igual que si no hubiera fallado
+{
+    if (fd == -1 or sin_confirmar == 0) return true;
+    size_t escrito = 0;
+    bool ok = true;
+    while (ok and escrito < pendientes.size()) {
+        ssize_t n = write(fd, &pendientes[escrito], pendientes.size() - escrito);
+        if (n > 0) escrito += n;
+        else if (n == 0 or errno != EINTR) ok = false;
+    }
+    pendientes.erase(pendientes.begin(), pendientes.begin() + escrito);
+    if (ok and lote > 0) {
+        int r;
+        do r = fdatasync(fd);
+        while (r != 0 and errno == EINTR);
+        ok = r == 0;
+    }
+    if (ok) sin_confirmar = 0;
+    return ok;
+}
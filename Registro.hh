@@ -0,0 +1,109 @@
+/** @file Registro.hh
+    @brief Especificación de la clase Registro
+*/
+
+#ifndef _REGISTRO_HH_
+#define _REGISTRO_HH_
+
+#ifndef NO_DIAGRAM
+#include <string>
+#include <vector>
+#include <mutex>
+using namespace std;
+#endif
+
+#include "Binario.hh"
+
+/** @class Registro
+    @brief Representa el registro (de escritura anticipada) de las funcionalidades que modifican la plataforma.
+
+    Cada funcionalidad modificadora se anota en el registro, con un número de orden (el "lsn") y el texto del comando tal y como se ha leído. Las anotaciones se acumulan en memoria y se escriben y sincronizan con el disco (fsync) en grupo: cuando se confirman explícitamente o cuando se llega a un número de anotaciones pendientes.
+
+    En el fichero, cada anotación ocupa: longitud del texto (4 bytes), lsn (8 bytes), texto y suma de comprobación (4 bytes). Una anotación incompleta o con la suma incorrecta (por ejemplo, porque el programa se interrumpió mientras se escribía) marca el final del registro.
+
+    Cuando se guarda el estado de la plataforma, las anotaciones anteriores ya no hacen falta para recuperarla: el registro se corta (vuelve a empezar vacío, manteniendo el lsn), y así recuperar solo cuesta leer lo que se ha anotado desde el último estado guardado.
+
+    Varios hilos pueden anotar y confirmar a la vez (por ejemplo, las conexiones del modo servidor): el parámetro implícito tiene un mutex que protege las anotaciones pendientes y el fichero.
+
+    Las operaciones son: abrir un registro (recuperando las anotaciones que ya contenía), consultar el lsn de la siguiente anotación, anotar un comando, confirmar las anotaciones pendientes y cortar el registro.
+*/
+
+class Registro
+{
+private:
+    /** @brief Descriptor del fichero del registro (-1 si no hay ninguno abierto) */
+    int fd;
+    /** @brief Nombre del fichero del registro */
+    string nombre;
+    /** @brief Anotaciones que todavía no se han escrito en el fichero */
+    vector<char> pendientes;
+    /** @brief Número de anotaciones que todavía no se han confirmado */
+    int sin_confirmar;
+    /** @brief Número de anotaciones a partir del cual se confirman automáticamente (0 para confirmar solo cuando se pide, sin sincronizar con el disco) */
+    int lote;
+    /** @brief Lsn que tendrá la siguiente anotación */
+    long long lsn;
+    /** @brief Mutex que protege las anotaciones pendientes y el fichero */
+    mutex m;
+
+public:
+    //Constructora y destructora
+    /** @brief Creadora
+        \pre lote >= 0
+        \post Se ha creado un registro sin fichero, que confirmará automáticamente cada "lote" anotaciones (si lote es 0, las confirmaciones no sincronizan con el disco)
+        \coste Constante
+    */
+    explicit Registro(int lote);
+
+    /** @brief Destructora
+        \pre <em>cierto</em>
+        \post Se han confirmado las anotaciones pendientes (si se ha podido) y se ha cerrado el fichero
+    */
+    ~Registro();
+
+    //Consultoras
+    /** @brief Consulta el lsn de la siguiente anotación
+        \pre <em>cierto</em>
+        \post Retorna el lsn que tendrá la siguiente anotación (es decir, el número de anotaciones hechas en el registro desde que se creó el fichero)
+        \coste Constante
+    */
+    long long consultar_lsn() const;
+
+    //Modificadoras
+    /** @brief Abre el fichero del registro
+        \pre No hay ningún fichero abierto en el parámetro implícito
+        \post Retorna false si no se puede abrir (o crear) el fichero "nombre". Si se puede, se han añadido a "comandos" los textos de las anotaciones válidas del fichero con lsn >= desde (por orden), se ha descartado lo que hubiera detrás de la última anotación válida, y las siguientes anotaciones se añadirán al final del fichero (con lsn a partir del siguiente al de la última anotación válida, y como mínimo "desde")
+    */
+    bool abrir(const string& nombre, long long desde, vector<string>& comandos);
+
+    /** @brief Anota un comando en el registro
+        \pre Hay un fichero abierto en el parámetro implícito
+        \post Se ha añadido a las anotaciones pendientes una con el texto "comando" y el siguiente lsn. Si con ella se llega al tamaño del lote, se han confirmado las anotaciones pendientes. Retorna false si la confirmación ha fallado
+        \coste Lineal en la longitud del comando (amortizado)
+    */
+    bool anotar(const string& comando);
+
+    /** @brief Confirma las anotaciones pendientes
+        \pre <em>cierto</em>
+        \post Si retorna true, se han escrito en el fichero todas las anotaciones pendientes y, si el lote no es 0, se ha sincronizado el fichero con el disco. Si retorna false, no se ha podido (por ejemplo, porque el disco está lleno): lo que no se ha llegado a escribir o sincronizar sigue pendiente, y la siguiente confirmación lo vuelve a intentar
+    */
+    bool confirmar();
+
+    /** @brief Corta el registro
+        \pre Hay un fichero abierto en el parámetro implícito. Se ha guardado (y sincronizado con el disco) un estado de la plataforma con lsn "desde", que es con el que se recuperará
+        \post Si todas las anotaciones tienen lsn menor que "desde" y se han podido confirmar, retorna true y el fichero se ha sustituido por uno vacío (las siguientes anotaciones siguen con el mismo lsn). Si no, retorna false y el fichero sigue con todas sus anotaciones. El fichero nuevo se escribe con otro nombre y después se renombra, así que aunque el sistema se interrumpa, el fichero es el antiguo entero o el nuevo
+    */
+    bool cortar(long long desde);
+
+private:
+    /** @brief Escribe las anotaciones pendientes
+        \pre El hilo tiene el mutex del parámetro implícito
+        \post Lo mismo que confirmar
+    */
+    bool escribir_pendientes();
+
+    /** @brief Los objetos no se pueden copiar (el fichero solo se puede cerrar una vez) */
+    Registro(const Registro&);
+    Registro& operator=(const Registro&);
+};
+#endif
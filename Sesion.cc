@@ -4,106 +4,110 @@
 #include "Sesion.hh"
 
                                                         //Constructora
-Sesion::Sesion()
-{
-    num_problemas = 0;
-}
+Sesion::Sesion() {}
 
                                                           //Consultoras
-bool Sesion::interseccion(Curso& c, string s) const
-//esta funcion modifica el Curso anadiendole todos los problemas del parametro implicito
-//si encuentra que en el Curso hay dos problemas que se repiten, para de anadir y retorna false
-{
-    return interseccion_i(problemas, c, s);
-}
-
-
-bool Sesion::interseccion_i (const BinTree<string>& a, Curso& c, string s)
-//esta funcion es de caracter private
+void Sesion::interseccion(Curso& c, int s) const
+//esta funcion modifica el Curso anadiendole todos los problemas del parametro implicito (en preorden, que es el orden del vector de nodos)
+//los problemas que se repiten entre sesiones se detectan al acabar de leer el curso, al ordenar sus problemas
 {
-    if (a.empty()) return true;
-    return c.insertar_problema(a.value(), s) and interseccion_i(a.left(), c, s) and interseccion_i(a.right(), c, s);
+    for (int i = 0; i < nodos.size(); ++i) c.insertar_problema(nodos[i].problema, s, i);
 }
 
 
-
-void Sesion::actualizar_enviables_iniciales(Usuario& u) const
+void Sesion::actualizar_enviables_iniciales(Usuario& u, int base) const
 //esta funcion la utilizo para la primera vez que busco los enviables de una sesion. Es decir, cuando inscribo un usuario en un curso.
 {
-    enviables(problemas, u);
+    if (not nodos.empty()) enviables(0, base, u);
 }
 
-void Sesion::enviables(const BinTree<string>& a, Usuario& u)
+void Sesion::enviables(int i, int base, Usuario& u) const
 //esta funcion es de caracter private
-//recorre el BinTree de problemas del parametro implicito hasta que se encuentra con aquellos problemas que el Usuario u tiene resueltos sus prerrequisitos pero no el problema en cuestion. Se anaden dichos problemas a los enviables de u
+//recorre el arbol de problemas del parametro implicito hasta que se encuentra con aquellos problemas que el Usuario u tiene resueltos sus prerrequisitos pero no el problema en cuestion. Se anaden dichos problemas a los enviables de u
+//el indice local (dentro del curso) del problema del nodo i es base + i, asi que no hace falta buscarlo
 {
-  if (not a.empty()) {
-      if (not u.esta_verdes_usuario(a.value())) u.anadir_problema_enviable_usuario(a.value());
+  if (i != -1) {
+      const Nodo& n = nodos[i];
+      if (not u.esta_verdes_usuario(base + i)) u.anadir_problema_enviable_usuario(base + i);
       else {
-          enviables(a.left(), u);
-          enviables(a.right(), u);
+          enviables(n.izq, base, u);
+          enviables(n.der, base, u);
       }
   }
 }
 
 
-void Sesion::actualizar_enviables(Usuario& u, const string& resuelto) const
-//esta funcion la utilizo en envio, cuando el usuario ha resuelto el problema "resuelto", para buscar los enviables que se le han desbloqueado
+void Sesion::actualizar_enviables(Usuario& u, int nodo, int base) const
+//esta funcion la utilizo en envio, cuando el usuario ha resuelto el problema del nodo "nodo", para buscar los enviables que se le han desbloqueado
+//el problema ya esta entre los verdes del usuario, asi que enviables() pasa directamente a mirar sus hijos
 {
-    busca_y_actualiza(problemas, u, resuelto);
-}
-
-void Sesion::busca_y_actualiza(const BinTree<string>& a, Usuario& u, const string& resuelto)
-//esta funcion es de caracter private
-{
-  if (not a.empty()) {
-      if (a.value() == resuelto) enviables(a,u); //si a es el subarbol que tiene por raiz el problema "resuelto", actualizamos los enviables del usuario
-      else { //si a no es el subarbol que tiene por raiz "problema", tenemos que recorrer el hijo (izquierdo o derecho) hasta encontrar el subarbol con raiz: "problema"
-          busca_y_actualiza(a.left(),u,resuelto);
-          busca_y_actualiza(a.right(),u,resuelto);
-      }
-  }
+    enviables(nodo, base, u);
 }
 
                                                     //Lectura y escritura
-void Sesion::leer_sesion()
+void Sesion::leer_sesion(const Tabla_ids& ids_problemas)
 //lee la estructura de problemas de la sesion (en preorden)
 {
-    int np = 0;
-    leer_estructura_problemas(problemas, np);
-    num_problemas = np;
+    nodos.clear();
+    leer_estructura_problemas(ids_problemas);
 }
 
-void Sesion::leer_estructura_problemas(BinTree<string>& a, int& np)
+int Sesion::leer_estructura_problemas(const Tabla_ids& ids_problemas)
 //esta funcion es de caracter private
 {
     string id;
-    cin >> id;
-    if (id!="0"){
-        ++np;
-        BinTree<string> l;
-        leer_estructura_problemas(l,np);
-        BinTree<string> r;
-        leer_estructura_problemas(r,np);
-        a=BinTree<string>(id,l,r);
-    }
+    entrada >> id;
+    if (id == "0") return -1;
+    int i = nodos.size();
+    Nodo n;
+    n.problema = ids_problemas.consultar_indice(id);
+    n.izq = n.der = -1;
+    nodos.push_back(n);
+    int izq = leer_estructura_problemas(ids_problemas);
+    int der = leer_estructura_problemas(ids_problemas);
+    nodos[i].izq = izq; //no guardamos referencias a nodos[i]: las llamadas recursivas pueden hacer crecer el vector
+    nodos[i].der = der;
+    return i;
 }
 
-void Sesion::escribir_sesion() const
+void Sesion::escribir_sesion(const Tabla_ids& ids_problemas) const
 //escribe la estructura de problemas de la sesion (en postorden)
 {
-    cout << num_problemas << " ";
-    escribir_estructura_problemas(problemas);
+    salida << nodos.size() << " ";
+    if (not nodos.empty()) escribir_estructura_problemas(0, ids_problemas);
 }
 
-void Sesion::escribir_estructura_problemas(const BinTree<string> &a)
+void Sesion::escribir_estructura_problemas(int i, const Tabla_ids& ids_problemas) const
 //esta funcion es de caracter private
 {
-	if (not a.empty()) {
-        cout << "(";
-        string id = a.value();
-        escribir_estructura_problemas(a.left());
-        escribir_estructura_problemas(a.right());
-        cout << id << ")";
+	if (i != -1) {
+        salida << "(";
+        escribir_estructura_problemas(nodos[i].izq, ids_problemas);
+        escribir_estructura_problemas(nodos[i].der, ids_problemas);
+        salida << ids_problemas.consultar_id(nodos[i].problema) << ")";
   }
 }
+
+                                                    //Lectura y escritura en formato binario
+void Sesion::guardar(Escritor_binario& f) const
+{
+    f.escribir_entero(nodos.size());
+    for (int i = 0; i < nodos.size(); ++i) {
+        f.escribir_entero(nodos[i].problema);
+        f.escribir_entero(nodos[i].izq);
+        f.escribir_entero(nodos[i].der);
+    }
+}
+
+void Sesion::cargar(Lector_binario& f)
+{
+    nodos.clear();
+    int n = f.leer_cantidad(3*sizeof(int));
+    for (int i = 0; i < n and not f.fallo(); ++i) {
+        Nodo x;
+        x.problema = f.leer_entero();
+        x.izq = f.leer_entero();
+        x.der = f.leer_entero();
+        nodos.push_back(x);
+    }
+}
@@ -10,14 +10,14 @@
 
 #ifndef NO_DIAGRAM
 #include <iostream>
-#include "BinTree.hh"
+#include <vector>
 using namespace std;
 #endif
 
 /** @class Sesion
     @brief Representa la información y las operaciones asociadas a una sesión.
 
-     La información de una sesión viene dada por los atributos: estructura de problemas que la forman, número de problemas que la forman.
+     La información de una sesión viene dada por la estructura de problemas que la forman: un árbol binario de prerrequisitos, guardado en un vector en preorden donde cada nodo indica la posición de sus hijos. El número de problemas que la forman es el tamaño del vector. Cada Curso guarda, para cada uno de sus problemas, la posición de su nodo, de manera que no hace falta buscarlo.
 
      Las operaciones son: lectura y escritura de una sesión, consultora de intersección (con un curso) (mira si hay coincidencia entre los problemas de un curso dado y la sesión), consultora de enviables iniciales (de un Usuario) (mira cuáles son los problemas de la sesión que un usuario dado tiene los prerrequisitos resueltos),  consultora de enviables (de un Usuario) (mira, a partir de un problema dado acabado de resolver, cuáles son los problemas de la sesión que un usuario dado ha desbloqueado).
 */
@@ -25,86 +25,95 @@ using namespace std;
 class Sesion
 {
 private:
-    /** @brief Estructura de los identificadores de problemas de la Sesion */
-    BinTree <string> problemas;
-    /** @brief Número de problemas totales que contiene la Sesion */
-    int num_problemas;
+    /** @brief Nodo del árbol de prerrequisitos: índice del problema y posiciones (dentro del vector de nodos) de sus hijos, -1 si no tiene */
+    struct Nodo {
+        int problema;
+        int izq;
+        int der;
+    };
+    /** @brief Estructura de los problemas de la Sesion, en preorden (la raíz, si la hay, está en la posición 0) */
+    vector<Nodo> nodos;
 
 public:
     //Constructora
     /** @brief Creadora por defecto.
         Se ejecuta automáticamente al declarar una sesión.
-        \pre En el canal de entrada se encuentra un string con el identificador de la sesión
+        \pre <em>cierto</em>
         \post Se ha creado una sesión vacía, sin estructura de problemas
         \coste Constante
     */
     Sesion();
 
     //Consultoras
-    /** @brief Informa de si hay intersección de problemas entre el parámetro implícito y el Curso c
-        \pre c es un Curso, s es el string que identifica el parámetro implícito
-        \post Si hay alguna coincidencia entre los problemas del parámetro implícito y los del Curso c, retorna false. Si no, retorna true y además se ha modificado c y se le han añadido todos los problemas de la sesión, cada uno aparejado con el identificador de sesión "s"
+    /** @brief Añade los problemas del parámetro implícito a un Curso que se está leyendo
+        \pre c es un Curso que se está leyendo, s es el índice que identifica el parámetro implícito
+        \post Se han añadido a c todos los problemas de la sesión, cada uno aparejado con el índice de sesión "s" y con la posición de su nodo. Si alguno ya estaba en c, se detecta al acabar el curso (ver Curso::ordenar_problemas)
+        \coste Lineal en el número de problemas de la sesión
     */
-    bool interseccion(Curso& c, const string s) const;
+    void interseccion(Curso& c, int s) const;
 
     /** @brief Función de comparación de los problemas del parámetro implícito con los del Usuario u
-        \pre u es un Usuario que se acaba de inscribir en un curso. El parámetro implícito es una de las sesiones del curso en cuestión
+        \pre u es un Usuario que se acaba de inscribir en un curso (con el progreso ya preparado para el curso). El parámetro implícito es una de las sesiones del curso en cuestión, y base es el índice local de su primer problema dentro del curso
         \post Se han añadido a u todos los problemas que puede intentar resolver (enviables) de esta Sesion
     */
-    void actualizar_enviables_iniciales(Usuario& u) const;
+    void actualizar_enviables_iniciales(Usuario& u, int base) const;
 
     /** @brief Función de comparación de los problemas del Usuario u con los del parámetro implícito (solamente comparando a partir del problema "resuelto")
-        \pre u es un Usuario inscrito en un curso que acaba de hacer un envio correcto del problema "resuelto". El parámetro implícito es la Sesion del curso que contiene el problema que acaba de resolver
-        \post Se han añadido a u todos los problemas enviables que ha desbloqueado al haber resuelto el problema "resuelto"
+        \pre u es un Usuario inscrito en un curso que acaba de hacer un envio correcto de un problema. El parámetro implícito es la Sesion del curso que contiene el problema que acaba de resolver, nodo es la posición del nodo de ese problema y base es el índice local del primer problema de la sesión dentro del curso
+        \post Se han añadido a u todos los problemas enviables que ha desbloqueado al haber resuelto el problema
+        \coste Lineal en el número de hijos del nodo (más los descendientes que u ya tuviera resueltos)
     */
-    void actualizar_enviables(Usuario& u, const string& resuelto) const;
+    void actualizar_enviables(Usuario& u, int nodo, int base) const;
 
     //Lectura y escritura
     /** @brief Lectura de una sesión.
         Permite leer el id y los problemas de una sesión
-        \pre En el canal de entrada se encuentra una secuencia de problemas (en preorden según los prerrequisitos)
+        \pre En el canal de entrada se encuentra una secuencia de problemas (en preorden según los prerrequisitos), todos ellos presentes en ids_problemas
         \post Se ha realizado la lectura de la sesión (y ahora el parámetro implícito ha pasado a tener la secuencia de problemas)
         \coste Lineal en el número de problemas de la sesión
     */
-    void leer_sesion();
+    void leer_sesion(const Tabla_ids& ids_problemas);
 
     /** @brief Escritura de una sesión.
         Permite escribir el contenido de una sesión
-        \pre <em>cierto</em>
+        \pre ids_problemas es la tabla de identificadores de los problemas de la plataforma
         \post Se ha escrito en el canal de salida el número de problemas del parámetro implícito, y la secuencia de identificadores de los problemas que la forman (en postorden)
         \coste Lineal en el número de problemas de la sesión
     */
-    void escribir_sesion() const;
+    void escribir_sesion(const Tabla_ids& ids_problemas) const;
+
+    //Lectura y escritura en formato binario
+    /** @brief Escritura de una sesión en formato binario
+        \pre f es un fichero binario abierto para escritura
+        \post Se ha escrito en f el contenido del parámetro implícito
+        \coste Lineal en el número de problemas de la sesión
+    */
+    void guardar(Escritor_binario& f) const;
+
+    /** @brief Lectura de una sesión en formato binario
+        \pre En la posición actual de f hay un contenido escrito con guardar
+        \post El parámetro implícito pasa a tener el contenido leído de f
+        \coste Lineal en el número de problemas de la sesión
+    */
+    void cargar(Lector_binario& f);
 
 private:
     /** @brief Lectura de la estructura de problemas de una sesión
         \pre En el canal de entrada se encuentra una secuencia de problemas (en preorden según los prerrequisitos)
-        \post Se ha realizado la lectura de los problemas y se han guardado en el BinTree que contiene los problemas
+        \post Se ha realizado la lectura de los problemas y se han añadido sus nodos (en preorden) al final del vector de nodos. Retorna la posición del nodo raíz de lo que se ha leído, o -1 si era un árbol vacío
     */
-    static void leer_estructura_problemas(BinTree<string>& a, int& np);
+    int leer_estructura_problemas(const Tabla_ids& ids_problemas);
 
     /** @brief Escritura de la estructura de problemas de una sesión
-        \pre a es el BinTree que contiene los problemas de la sesion ordenados por prerrequisitos
-        \post Se ha escrito el contenido de a en el canal de salida (en postorden)
+        \pre i es la posición de un nodo del parámetro implícito, o -1
+        \post Se ha escrito el subárbol que tiene por raíz el nodo i en el canal de salida (en postorden)
     */
-    static void escribir_estructura_problemas(const BinTree<string>& a);
-
-    /** @brief Inmersión de la consultora de si hay intersección de problemas entre el parámetro implícito y el Curso c
-        \pre c es un Curso, s es el string que identifica el parámetro implícito, a es el BinTree de probemas del parámetro implícito
-        \post Si hay alguna coincidencia entre los problemas del parámetro implícito y los del Curso c, retorna false. Si no, retorna true y además modifica c añadiendole todos los problemas de la sesión, cada uno aparejado con el identificador de sesión "s"
-    */
-    static bool interseccion_i (const BinTree<string>& a, Curso& c, string s);
+    void escribir_estructura_problemas(int i, const Tabla_ids& ids_problemas) const;
 
     /** @brief Inmersión de función de comparación de los problemas del parámetro implícito con los del Usuario u
-        \pre u es un Usuario que se acaba de inscribir en un curso. El parámetro implícito es una de las sesiones del curso en cuestión. a es el BinTree de problemas del parámetro implícito
-        \post Se ha recorrido el BinTree a hasta encontrar los problemas que u tiene resueltos los prerrequisitos, pero no el problema (es decir, los problemas enviables). Además, se ha modificado u añadiendole dichos problemas
-    */
-    static void enviables(const BinTree<string>& a, Usuario& u);
-
-    /** @brief Inmersión de función de comparación de los problemas del Usuario u con los del parámetro implícito (solamente comparando a partir del problema "resuelto")
-        \pre u es un Usuario inscrito en un curso que acaba de hacer un envio correcto del problema "resuelto". El parámetro implícito es la Sesion del curso que contiene el problema que acaba de resolver. a es un BinTree que contiene el subárbol que tiene por raíz el problema "resuelto"
-        \post Se han añadido a u todos los problemas enviables que ha desbloqueado al haber resuelto el problema "resuelto"
+        \pre u es un Usuario que se acaba de inscribir en un curso. El parámetro implícito es una de las sesiones del curso en cuestión, y base es el índice local de su primer problema dentro del curso. i es la posición de un nodo del parámetro implícito, o -1
+        \post Se ha recorrido el subárbol que tiene por raíz el nodo i hasta encontrar los problemas que u tiene resueltos los prerrequisitos, pero no el problema (es decir, los problemas enviables). Además, se ha modificado u añadiendole dichos problemas
     */
-    static void busca_y_actualiza(const BinTree<string>& a, Usuario& u, const string& resuelto); //OK
+    void enviables(int i, int base, Usuario& u) const;
 };
 #endif
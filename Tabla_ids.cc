@@ -0,0 +1,63 @@
+/** @file Tabla_ids.cc
+    @brief Implementación de la clase Tabla_ids
+*/
+#include "Tabla_ids.hh"
+
+                                                    //Constructora
+Tabla_ids::Tabla_ids() {}
+                                                    //Consultoras
+int Tabla_ids::consultar_indice(const string& id) const
+{
+    unordered_map<string, int>::const_iterator it = indices.find(id);
+    if (it == indices.end()) return -1;
+    return it->second;
+}
+
+const string& Tabla_ids::consultar_id(int i) const
+{
+    return *ids[i];
+}
+
+int Tabla_ids::size() const
+{
+    return ids.size();
+}
+
+Tabla_ids::const_iterator Tabla_ids::begin() const
+{
+    return orden.begin();
+}
+
+Tabla_ids::const_iterator Tabla_ids::end() const
+{
+    return orden.end();
+}
+
+Tabla_ids::const_iterator Tabla_ids::desde(const string& id) const
+{
+    return orden.lower_bound(&id);
+}
+                                                    //Modificadoras
+int Tabla_ids::anadir(const string& id)
+//las claves de un unordered_map no se mueven de sitio aunque la tabla crezca, por eso podemos guardar punteros a ellas en "ids" y en "orden"
+{
+    pair<unordered_map<string, int>::iterator, bool> nou = indices.insert(make_pair(id, int(ids.size())));
+    if (nou.second) {
+        const string* clave = &nou.first->first;
+        ids.push_back(clave);
+        orden.insert(make_pair(clave, nou.first->second));
+    }
+    return nou.first->second;
+}
+                                                    //Lectura y escritura en formato binario
+void Tabla_ids::guardar(Escritor_binario& f) const
+{
+    f.escribir_entero(ids.size());
+    for (int i = 0; i < ids.size(); ++i) f.escribir_string(*ids[i]);
+}
+
+void Tabla_ids::cargar(Lector_binario& f)
+{
+    int n = f.leer_cantidad(sizeof(int));
+    for (int i = 0; i < n and not f.fallo(); ++i) anadir(f.leer_string());
+}
@@ -0,0 +1,122 @@
+/** @file Tabla_ids.hh
+    @brief Especificación de la clase Tabla_ids
+*/
+
+#ifndef _TABLA_IDS_HH_
+#define _TABLA_IDS_HH_
+
+#ifndef NO_DIAGRAM
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+using namespace std;
+#endif
+
+#include "Binario.hh"
+
+/** @brief Cursor de los listados por páginas que indica que la página empieza por el principio del listado */
+const string DESDE_INICIO = "-";
+
+/** @class Tabla_ids
+    @brief Representa una tabla de símbolos que asocia a cada identificador (string) un entero denso.
+
+    Cada identificador se guarda una sola vez (en el momento de leerlo), y a partir de entonces el resto de clases trabajan con el entero (el "índice") que le corresponde. Los índices se asignan consecutivamente a partir de 0, en el orden en que se añaden los identificadores.
+
+    Las operaciones son: añadir un identificador, consultar el índice de un identificador, consultar el identificador de un índice, consultar el número de identificadores, y recorrer los índices ordenados por identificador (desde el principio o desde un identificador cualquiera).
+*/
+
+class Tabla_ids
+{
+public:
+    /** @brief Función de comparación de punteros a identificadores (compara los identificadores, no los punteros) */
+    struct Menor_id {
+        bool operator()(const string* a, const string* b) const { return *a < *b; }
+    };
+    /** @brief Tipo del recorrido ordenado por identificador (cada elemento es la pareja identificador - índice) */
+    typedef map<const string*, int, Menor_id>::const_iterator const_iterator;
+
+private:
+    /** @brief Estructura que asocia a cada identificador su índice */
+    unordered_map<string, int> indices;
+    /** @brief Estructura que asocia a cada índice su identificador (apunta a la clave guardada en "indices") */
+    vector<const string*> ids;
+    /** @brief Estructura que contiene los índices ordenados por identificador */
+    map<const string*, int, Menor_id> orden;
+
+public:
+    //Constructora
+    /** @brief Creadora por defecto
+        \pre <em>cierto</em>
+        \post Se ha creado una tabla sin ningún identificador
+        \coste Constante
+    */
+    Tabla_ids();
+
+    //Consultoras
+    /** @brief Consulta el índice de un identificador
+        \pre <em>cierto</em>
+        \post Retorna el índice asociado a id si está en la tabla, -1 si no lo está
+        \coste Constante (en media)
+    */
+    int consultar_indice(const string& id) const;
+
+    /** @brief Consulta el identificador de un índice
+        \pre 0 <= i < número de identificadores de la tabla
+        \post Retorna el identificador asociado al índice i
+        \coste Constante
+    */
+    const string& consultar_id(int i) const;
+
+    /** @brief Consulta el número de identificadores de la tabla
+        \pre <em>cierto</em>
+        \post Retorna el número de identificadores que contiene el parámetro implícito
+        \coste Constante
+    */
+    int size() const;
+
+    /** @brief Inicio del recorrido ordenado por identificador
+        \pre <em>cierto</em>
+        \post Retorna un iterador a la pareja (identificador, índice) con el identificador más pequeño
+        \coste Constante
+    */
+    const_iterator begin() const;
+
+    /** @brief Final del recorrido ordenado por identificador
+        \pre <em>cierto</em>
+        \post Retorna el iterador que sigue a la última pareja (identificador, índice)
+        \coste Constante
+    */
+    const_iterator end() const;
+
+    /** @brief Inicio del recorrido ordenado a partir de un identificador
+        \pre <em>cierto</em>
+        \post Retorna un iterador a la pareja (identificador, índice) con el identificador más pequeño que no es menor que id (end() si no hay ninguna). id no tiene por qué estar en la tabla
+        \coste Logarítmico en el número de identificadores
+    */
+    const_iterator desde(const string& id) const;
+
+    //Modificadoras
+    /** @brief Añade un identificador a la tabla
+        \pre <em>cierto</em>
+        \post Si id ya estaba en la tabla, retorna su índice. Si no, se le ha asignado el índice "número de identificadores" y se retorna
+        \coste Logarítmico en el número de identificadores
+    */
+    int anadir(const string& id);
+
+    //Lectura y escritura en formato binario
+    /** @brief Escritura de la tabla en formato binario
+        \pre f es un fichero binario abierto para escritura
+        \post Se han escrito en f todos los identificadores, por orden de índice
+        \coste Lineal en el número de identificadores
+    */
+    void guardar(Escritor_binario& f) const;
+
+    /** @brief Lectura de la tabla en formato binario
+        \pre El parámetro implícito está vacío. En la posición actual de f hay una tabla escrita con guardar
+        \post El parámetro implícito contiene los identificadores leídos de f, cada uno con el mismo índice que tenía al guardarlo
+        \coste n*log(n), n = número de identificadores
+    */
+    void cargar(Lector_binario& f);
+};
+#endif
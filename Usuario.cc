@@ -2,14 +2,62 @@
     @brief Implementación de la clase Usuario
 */
 #include "Usuario.hh"
-typedef map<string,int>::iterator it;
-typedef map<string,int>::const_iterator c_it;
+typedef Mapa_verdes::const_iterator c_it;
+
+//los conjuntos de bits se guardan en palabras de 64 bits: el indice local j esta en el bit j%64 de la palabra j/64
+static int palabras(int n)
+{
+    return (n + 63)/64;
+}
+
+static bool consultar_bit(const vector<unsigned long long>& v, int j)
+{
+    return (v[j >> 6] >> (j & 63)) & 1;
+}
+
+static void poner_bit(vector<unsigned long long>& v, int j)
+{
+    v[j >> 6] |= 1ULL << (j & 63);
+}
+
+static void quitar_bit(vector<unsigned long long>& v, int j)
+{
+    v[j >> 6] &= ~(1ULL << (j & 63));
+}
 
                                             //Constructora
-Usuario::Usuario() {
+Usuario::Usuario() : region(new Region), verdes(less<int>(), Mapa_verdes::allocator_type(region.get())) {
     curso = 0;
     envios_totales = 0;
     intentados = 0;
+    num_problemas_curso = 0;
+    num_verdes_curso = 0;
+    num_envios_curso = 0;
+}
+
+Usuario::Usuario(const Usuario& u)
+//el map copiado no puede compartir la region de u: cada usuario tiene la suya
+    : curso(u.curso), envios_totales(u.envios_totales), intentados(u.intentados), region(new Region),
+      verdes(u.verdes.begin(), u.verdes.end(), less<int>(), Mapa_verdes::allocator_type(region.get())),
+      verdes_curso(u.verdes_curso), enviables(u.enviables), envios_curso(u.envios_curso),
+      num_problemas_curso(u.num_problemas_curso), num_verdes_curso(u.num_verdes_curso),
+      num_envios_curso(u.num_envios_curso) {}
+
+Usuario& Usuario::operator=(Usuario u)
+//intercambiamos todo, region incluida (el map intercambia tambien su asignador), y u se lleva el contenido antiguo
+{
+    swap(curso, u.curso);
+    swap(envios_totales, u.envios_totales);
+    swap(intentados, u.intentados);
+    region.swap(u.region);
+    verdes.swap(u.verdes);
+    verdes_curso.swap(u.verdes_curso);
+    enviables.swap(u.enviables);
+    envios_curso.swap(u.envios_curso);
+    swap(num_problemas_curso, u.num_problemas_curso);
+    swap(num_verdes_curso, u.num_verdes_curso);
+    swap(num_envios_curso, u.num_envios_curso);
+    return *this;
 }
                                             //Consultoras
 int Usuario::consultar_curso_usuario() const
@@ -18,18 +66,43 @@ int Usuario::consultar_curso_usuario() const
 }
 
 bool Usuario::ha_completado_curso() const
+//si quedara algun problema por resolver, el primero no resuelto de su camino desde la raiz seria enviable; asi que basta con comparar contadores
+{
+  return num_verdes_curso == num_problemas_curso;
+}
+
+bool Usuario::esta_verdes_usuario(int j) const
+{
+    return consultar_bit(verdes_curso, j);
+}
+
+int Usuario::consultar_resueltos_curso() const
 {
-  return enviables.empty();
+    return num_verdes_curso;
 }
 
-bool Usuario::esta_verdes_usuario(string id) const
+int Usuario::consultar_envios_curso() const
 {
-    c_it it = verdes.find(id);
-    if (it == verdes.end()) return false;
-    return true;
+    return num_envios_curso;
 }
 
                                           //Modificadoras
+void Usuario::preparar_curso(const Curso& c)
+//marcamos los problemas del curso que el usuario ya tenia resueltos de cursos anteriores, y los contamos de golpe con popcount
+{
+    num_problemas_curso = c.consultar_num_problemas_curso();
+    int n = palabras(num_problemas_curso);
+    verdes_curso.assign(n, 0);
+    enviables.assign(n, 0);
+    envios_curso.assign(num_problemas_curso, 0);
+    for (c_it it = verdes.begin(); it != verdes.end(); ++it) {
+        int j = c.consultar_local(it->first);
+        if (j != -1) poner_bit(verdes_curso, j);
+    }
+    num_verdes_curso = num_envios_curso = 0;
+    for (int i = 0; i < n; ++i) num_verdes_curso += __builtin_popcountll(verdes_curso[i]);
+}
+
 void Usuario::inscribir_usuario(int id_curso) {
     curso = id_curso;
 }
@@ -37,39 +110,143 @@ void Usuario::inscribir_usuario(int id_curso) {
 int Usuario::desinscribir() {
     int aux = curso;
     curso = 0;
+    num_problemas_curso = num_verdes_curso = num_envios_curso = 0;
+    vector<unsigned long long>().swap(verdes_curso); //liberamos la memoria del progreso, no solo la vaciamos
+    vector<unsigned long long>().swap(enviables);
+    vector<int>().swap(envios_curso);
     return aux;
 }
 
-void Usuario::actualizar_problemas(string p, int r) {
+void Usuario::reiniciar()
+//primero el map (que ya no usara la region) y despues la region
+{
+    curso = 0;
+    envios_totales = 0;
+    intentados = 0;
+    num_problemas_curso = num_verdes_curso = num_envios_curso = 0;
+    verdes.clear();
+    region->vaciar();
+    verdes_curso.clear();
+    enviables.clear();
+    envios_curso.clear();
+}
+
+bool Usuario::actualizar_problemas(int p, int j, int r) {
     ++envios_totales;
-    it it_p = enviables.find(p);
-    if (it_p->second == 0) ++intentados; //miramos si es la primera vez que lo intenta. si lo es, incrementamos el numero de "problemas intentados" del parametro implicito
-    ++it_p->second;
+    ++num_envios_curso;
+    bool primero = envios_curso[j] == 0;
+    if (primero) ++intentados; //miramos si es la primera vez que lo intenta. si lo es, incrementamos el numero de "problemas intentados" del parametro implicito
+    ++envios_curso[j];
     if (r) { //si el parametro implicito ha resuelto el problema correctamente, lo quitamos de "enviables" y lo ponemos a "verdes"
-      verdes.insert(*it_p);
-      enviables.erase(it_p);
+      verdes.insert(make_pair(p, envios_curso[j]));
+      quitar_bit(enviables, j);
+      poner_bit(verdes_curso, j);
+      ++num_verdes_curso;
     }
+    return primero;
+}
+
+void Usuario::copiar_enviables(const vector<unsigned long long>& bits)
+{
+    enviables.assign(bits.begin(), bits.end()); //conserva la capacidad que ya tuviera
 }
 
-void Usuario::anadir_problema_enviable_usuario(string p)
+void Usuario::anadir_problema_enviable_usuario(int j)
 //este metodo lo necesitamos para actualizar los enviables del usuario, lo llamamos desde la clase Sesion
 //(ya que desde alli comparamos los problemas de la sesion con los ya resueltos del usuario, y modificamos desde alli mismo los enviables del usuario)
 {
-    enviables.insert(make_pair(p, 0));
+    poner_bit(enviables, j);
 }
 
                                           //Escritura
 void Usuario::escribir_usuario() const
 {
-    cout << "(" << envios_totales << "," << verdes.size() << "," << intentados << "," << curso << ")" << endl;
+    salida << "(" << envios_totales << "," << verdes.size() << "," << intentados << "," << curso << ")" << '\n';
+}
+
+void Usuario::escribir_problemas_verdes_usuario(const Tabla_ids& ids_problemas) const
+//el map esta ordenado por indice (orden en que se anadieron los problemas a la plataforma), pero la salida tiene que estar ordenada por identificador
+{
+    vector< pair<string,int> > v;
+    v.reserve(verdes.size());
+    for (c_it it = verdes.begin(); it != verdes.end(); ++it) v.push_back(make_pair(ids_problemas.consultar_id(it->first), it->second));
+    escribir_problemas(v);
+}
+
+void Usuario::escribir_problemas_enviables_usuario(const Curso& c, const Tabla_ids& ids_problemas) const
+//recorremos las palabras de bits saltando directamente de un bit activo al siguiente
+{
+    vector< pair<string,int> > v;
+    for (int i = 0; i < enviables.size(); ++i) {
+        for (unsigned long long w = enviables[i]; w != 0; w &= w - 1) {
+            int j = i*64 + __builtin_ctzll(w);
+            v.push_back(make_pair(ids_problemas.consultar_id(c.consultar_problema_local(j)), envios_curso[j]));
+        }
+    }
+    escribir_problemas(v);
+}
+
+void Usuario::escribir_problemas(vector< pair<string,int> >& v)
+{
+    sort(v.begin(), v.end());
+    for (int i = 0; i < v.size(); ++i) salida << v[i].first << "(" << v[i].second << ")" << '\n';
+}
+
+                                          //Lectura y escritura en formato binario
+void Usuario::guardar(Escritor_binario& f) const
+{
+    f.escribir_entero(curso);
+    f.escribir_entero(envios_totales);
+    f.escribir_entero(intentados);
+    guardar_problemas(verdes, f);
+    f.escribir_entero(num_problemas_curso); //0 si no esta inscrito en ningun curso
+    for (int i = 0; i < verdes_curso.size(); ++i) {
+        f.escribir_entero_largo(verdes_curso[i]);
+        f.escribir_entero_largo(enviables[i]);
+    }
+    for (int j = 0; j < num_problemas_curso; ++j) f.escribir_entero(envios_curso[j]);
+}
+
+void Usuario::cargar(Lector_binario& f)
+{
+    curso = f.leer_entero();
+    envios_totales = f.leer_entero();
+    intentados = f.leer_entero();
+    cargar_problemas(verdes, f);
+    num_problemas_curso = f.leer_cantidad(sizeof(int));
+    int n = palabras(num_problemas_curso);
+    verdes_curso.assign(n, 0);
+    enviables.assign(n, 0);
+    num_verdes_curso = 0;
+    for (int i = 0; i < n and not f.fallo(); ++i) {
+        verdes_curso[i] = f.leer_entero_largo();
+        enviables[i] = f.leer_entero_largo();
+        num_verdes_curso += __builtin_popcountll(verdes_curso[i]);
+    }
+    envios_curso.assign(num_problemas_curso, 0);
+    num_envios_curso = 0;
+    for (int j = 0; j < num_problemas_curso and not f.fallo(); ++j) {
+        envios_curso[j] = f.leer_entero();
+        num_envios_curso += envios_curso[j];
+    }
 }
 
-void Usuario::escribir_problemas_verdes_usuario() const
+void Usuario::guardar_problemas(const Mapa_verdes& m, Escritor_binario& f)
 {
-    for (c_it it = verdes.begin(); it != verdes.end(); ++it) cout << it->first << "(" << it->second << ")" << endl;
+    f.escribir_entero(m.size());
+    for (c_it it = m.begin(); it != m.end(); ++it) {
+        f.escribir_entero(it->first);
+        f.escribir_entero(it->second);
+    }
 }
 
-void Usuario::escribir_problemas_enviables_usuario() const
+void Usuario::cargar_problemas(Mapa_verdes& m, Lector_binario& f)
+//los problemas se guardaron en orden, asi que cada uno se inserta al final del map (coste constante amortizado)
 {
-    for (c_it it = enviables.begin(); it != enviables.end(); ++it) cout << it->first << "(" << it->second << ")" << endl;
+    m.clear();
+    int n = f.leer_cantidad(2*sizeof(int));
+    for (int i = 0; i < n and not f.fallo(); ++i) {
+        int p = f.leer_entero();
+        m.insert(m.end(), make_pair(p, f.leer_entero()));
+    }
 }
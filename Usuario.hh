@@ -6,16 +6,27 @@
 #define USUARIO_HH_
 
 #include "Curso.hh"
+#include "Asignadores.hh"
 
 #ifndef NO_DIAGRAM
 #include <map>
 #include <utility>
+#include <vector>
+#include <algorithm>
+#include <memory>
 #endif
 
+/** @brief Conjunto de problemas verdes de un usuario (índice de problema y número de envíos), con los nodos reservados en la región del usuario */
+typedef map<int, int, less<int>, Asignador_region< pair<const int,int> > > Mapa_verdes;
+
 /** @class Usuario
     @brief Representa la información y las operaciones asociadas a un usuario.
 
-     La información de un usuario viene dada por los atributos: curso en el que está inscrito (si lo está), conjunto de problemas verdes (identifcador de problema y número de intentos), conjunto de problemas enviables (identificador de problema y número de intentos), stats (número de envíos que el usuario ha hecho en total, y número de problemas distintos que ha intentado).
+     La información de un usuario viene dada por los atributos: curso en el que está inscrito (si lo está), conjunto de problemas verdes (índice de problema y número de intentos), progreso en el curso en el que está inscrito, stats (número de envíos que el usuario ha hecho en total, y número de problemas distintos que ha intentado).
+
+     Los nodos del conjunto de problemas verdes se reservan en una región de memoria propia del usuario (ver Region): quedan juntos en memoria, y al destruir el usuario (por ejemplo, al darlo de baja) se liberan todos de golpe, bloque a bloque en lugar de nodo a nodo.
+
+     El progreso en el curso se guarda de forma densa sobre los índices locales de los problemas del curso (ver Curso): un conjunto de bits de los problemas resueltos, otro de los problemas enviables, y el número de envíos hechos a cada problema. Así, consultar si un problema está resuelto o añadir un enviable cuesta tiempo constante, y saber si el curso está completado se reduce a comparar el número de problemas resueltos (contados con popcount al inscribirse) con el número de problemas del curso.
 
      Las operaciones son: consultora del curso en el que el usuario está inscrito, consultora de si el usuario ha completado el curso en el que estaba inscrito, consultora de si un problema dado está resuelto por el usuario, escritura de un usuario, escritura de los problemas enviables o escritura de los problemas resueltos correctamente. Las operaciones modificadoras son: inscribir el usuario en un curso dado, desinscribirlo del curso en el que estaba, actualizar los stats de los problemas (tras haber realizado un envío), añadir un problema dado a los enviables.
 */
@@ -29,10 +40,22 @@ private:
     int envios_totales;
     /** @brief Número de problemas distintos que el usuario ha intentado (es decir, ha hecho almenos un envío) */
     int intentados;
-    /** @brief Estructura que contiene los identificadores de todos los problemas distintos que el usuario tiene los prerrequisitos cumplidos, con el número de envíos que ha hecho para cada problema */
-    map<string, int> enviables;
-    /** @brief Estructura que contiene los identificadores de todos los problemas resueltos correctamente, y el número de envíos para cada uno */
-    map<string, int> verdes;
+    /** @brief Región de la que se reservan los nodos de "verdes" (se declara antes para que se destruya después) */
+    unique_ptr<Region> region;
+    /** @brief Estructura que contiene los índices de todos los problemas resueltos correctamente, y el número de envíos para cada uno */
+    Mapa_verdes verdes;
+    /** @brief Bits (por índice local) de los problemas del curso actual que el usuario tiene resueltos */
+    vector<unsigned long long> verdes_curso;
+    /** @brief Bits (por índice local) de los problemas del curso actual que el usuario tiene los prerrequisitos cumplidos pero no los ha resuelto */
+    vector<unsigned long long> enviables;
+    /** @brief Número de envíos que el usuario ha hecho a cada problema del curso actual, por índice local */
+    vector<int> envios_curso;
+    /** @brief Número de problemas del curso actual */
+    int num_problemas_curso;
+    /** @brief Número de problemas del curso actual que el usuario tiene resueltos */
+    int num_verdes_curso;
+    /** @brief Número de envíos que el usuario ha hecho desde que se inscribió en el curso actual */
+    int num_envios_curso;
 
 public:
     //Constructora
@@ -44,6 +67,27 @@ public:
     */
     Usuario();
 
+    /** @brief Creadora copiadora
+        \pre <em>cierto</em>
+        \post El resultado es una copia de u, con sus problemas verdes en una región propia
+        \coste Lineal en el número de problemas verdes y de problemas del curso actual de u
+    */
+    Usuario(const Usuario& u);
+
+    /** @brief Creadora por movimiento
+        \pre <em>cierto</em>
+        \post El resultado tiene el contenido (y la región) de u, que queda vacío y solo se puede destruir o asignar
+        \coste Constante
+    */
+    Usuario(Usuario&& u) = default;
+
+    /** @brief Asignación
+        \pre <em>cierto</em>
+        \post El parámetro implícito pasa a tener el contenido (y la región) de u, y u el que tenía el parámetro implícito, que se destruye con él
+        \coste Constante (más la copia de u, si es una copia)
+    */
+    Usuario& operator=(Usuario u);
+
     //Consultoras
     /** @brief Comprueba si actualmente el usuario está inscrito o no en algún curso
         \pre <em>cierto</em>
@@ -59,14 +103,35 @@ public:
     */
     bool ha_completado_curso() const;
 
-    /** @brief Informa sobre si un usuario ha resuelto un problema con éxito
-        \pre p es el identificador del problema que queremos saber si está solucionado con éxito
-        \post Retorna true si el problema con identificador p está entre los que el parámetro implícito ha solucionado con éxito. Si no, retorna false
-        \coste Logarítmico en el número de problemas resueltos correctamente
+    /** @brief Informa sobre si un usuario ha resuelto un problema del curso con éxito
+        \pre El parámetro implícito está inscrito en un curso (o bien lo estamos inscribiendo), j es el índice local de un problema de dicho curso
+        \post Retorna true si el problema con índice local j está entre los que el parámetro implícito ha solucionado con éxito. Si no, retorna false
+        \coste Constante
+    */
+    bool esta_verdes_usuario(int j) const;
+
+    /** @brief Consulta el número de problemas resueltos del curso actual
+        \pre el parámetro implícito está inscrito en un curso (o bien lo estamos inscribiendo)
+        \post Retorna el número de problemas del curso que el parámetro implícito tiene resueltos (incluidos los que ya tenía resueltos al inscribirse)
+        \coste Constante
     */
-    bool esta_verdes_usuario(string id) const;
+    int consultar_resueltos_curso() const;
+
+    /** @brief Consulta el número de envíos hechos en el curso actual
+        \pre el parámetro implícito está inscrito en un curso
+        \post Retorna el número de envíos que el parámetro implícito ha hecho desde que se inscribió en el curso
+        \coste Constante
+    */
+    int consultar_envios_curso() const;
 
     //Modificadoras
+    /** @brief Prepara el progreso del usuario para un curso
+        \pre El parámetro implícito no está inscrito en ningún curso, c es el curso en el que se le va a inscribir
+        \post El parámetro implícito tiene el progreso dimensionado para los problemas de c, sin enviables ni envíos, y con los problemas de c que ya tenía resueltos marcados como resueltos
+        \coste Lineal en el número de problemas de c más el número de problemas resueltos
+    */
+    void preparar_curso(const Curso& c);
+
     /** @brief Operación de inscripción en un curso
         \pre el parámetro implícito no está inscrito en ningún curso
         \post el parámetro implícito pasa a estar inscrito en el curso que tiene identificador "id_curso"
@@ -76,24 +141,38 @@ public:
 
     /** @brief Operación de desinscripción en un curso
         \pre el parámetro implícito está inscrito en un curso (y lo acaba de completar)
-        \post el parámetro implícito ya no está inscrito en ningún curso. Retorna el id del último curso en el que estaba inscrito
+        \post el parámetro implícito ya no está inscrito en ningún curso y se ha liberado su progreso. Retorna el id del último curso en el que estaba inscrito
         \coste Constante
     */
     int desinscribir();
 
-    /** @brief Operación de desinscripción en un curso
-        \pre el parámetro implícito está inscrito en un curso (y lo acaba de completar)
-        \post el parámetro implícito ya no está inscrito en ningún curso. Retorna el id del último curso en el que estaba inscrito
-        \coste Logarítmico en el número de problemas enviables
+    /** @brief Vacía el usuario para reaprovecharlo
+        \pre <em>cierto</em>
+        \post El parámetro implícito queda como un usuario recién creado (no inscrito y sin stats), pero conserva la memoria reservada: la capacidad de los vectores del progreso y el último bloque de su región
+        \coste Lineal en el número de problemas verdes
     */
-    void actualizar_problemas(string p, int r);
+    void reiniciar();
+
+    /** @brief Operación de actualizar los stats tras un envío
+        \pre el parámetro implícito está inscrito en un curso, p es el índice de un problema enviable del curso y j su índice local, r indica si el envío ha sido correcto
+        \post se ha contado el envío; si r, el problema ha pasado de enviable a resuelto. Retorna true si era el primer envío del parámetro implícito al problema
+        \coste Logarítmico en el número de problemas resueltos
+    */
+    bool actualizar_problemas(int p, int j, int r);
 
     /** @brief Operación de añadir un problema al historial de problemas enviables
-        \pre el problema p es enviable (ie, el parámetro implícito tiene resuelto correctamente su prerrequisito pero no el problema p)
-        \post se ha añadido el problema (con cero intentos) en el historial de enviables
-        \coste Logarítmico en el número de problemas enviables
+        \pre j es el índice local de un problema enviable del curso (ie, el parámetro implícito tiene resuelto correctamente su prerrequisito pero no el problema)
+        \post se ha añadido el problema en el historial de enviables
+        \coste Constante
     */
-    void anadir_problema_enviable_usuario(string p);
+    void anadir_problema_enviable_usuario(int j);
+
+    /** @brief Operación de poner de golpe todos los problemas enviables
+        \pre El parámetro implícito tiene el progreso preparado para un curso, y bits contiene los enviables (por índice local, una palabra por cada 64 problemas del curso)
+        \post Los enviables del parámetro implícito pasan a ser los de bits
+        \coste Lineal en el número de problemas del curso entre 64
+    */
+    void copiar_enviables(const vector<unsigned long long>& bits);
 
 
     //Escritura
@@ -105,17 +184,52 @@ public:
     void escribir_usuario() const;
 
     /** @brief Operación de escritura de los problemas realizados con éxito por un usuario
-        \pre <em>cierto</em>
-        \post Se ha escrito el listado de los identificadores de todos los problemas "verdes" del parámetro implícito, y junto a cada identificador se ha escrito el número total de envíos que el parámetro implícito ha hecho al problema
-        \coste Lineal en el número de problemas correctos
+        \pre ids_problemas es la tabla de identificadores de los problemas de la plataforma
+        \post Se ha escrito el listado (ordenado por identificador) de los identificadores de todos los problemas "verdes" del parámetro implícito, y junto a cada identificador se ha escrito el número total de envíos que el parámetro implícito ha hecho al problema
+        \coste n*log(n), n = número de problemas correctos
     */
-    void escribir_problemas_verdes_usuario() const;
+    void escribir_problemas_verdes_usuario(const Tabla_ids& ids_problemas) const;
 
     /** @brief Operación de escritura de los problemas enviables de un usuario
-        \pre <em>cierto</em>
-        \post Se ha escrito (en preorden) el listado de los identificadores de todos los problemas "enviables" del parámetro implícito, y junto a cada identificador se ha escrito el número total de envíos que el parámetro implícito ha hecho al problema
-        \coste Lineal en el número de problemas enviables
+        \pre c es el curso en el que está inscrito el parámetro implícito, ids_problemas es la tabla de identificadores de los problemas de la plataforma
+        \post Se ha escrito el listado (ordenado por identificador) de los identificadores de todos los problemas "enviables" del parámetro implícito, y junto a cada identificador se ha escrito el número total de envíos que el parámetro implícito ha hecho al problema
+        \coste Lineal en el número de problemas del curso más n*log(n), n = número de problemas enviables
+    */
+    void escribir_problemas_enviables_usuario(const Curso& c, const Tabla_ids& ids_problemas) const;
+
+    //Lectura y escritura en formato binario
+    /** @brief Escritura de un usuario en formato binario
+        \pre f es un fichero binario abierto para escritura
+        \post Se ha escrito en f el contenido del parámetro implícito
+        \coste Lineal en el número de problemas verdes y de problemas del curso actual
+    */
+    void guardar(Escritor_binario& f) const;
+
+    /** @brief Lectura de un usuario en formato binario
+        \pre En la posición actual de f hay un contenido escrito con guardar
+        \post El parámetro implícito pasa a tener el contenido leído de f
+        \coste Lineal en el número de problemas verdes y de problemas del curso actual
+    */
+    void cargar(Lector_binario& f);
+
+private:
+    /** @brief Escritura de un conjunto de problemas ordenado por identificador
+        \pre v es un conjunto de parejas (identificador de problema, número de envíos)
+        \post v queda ordenado por identificador, y se ha escrito cada problema de v en una línea (identificador y número de envíos entre paréntesis)
+        \coste n*log(n), n = número de problemas de v
+    */
+    static void escribir_problemas(vector< pair<string,int> >& v);
+
+    /** @brief Escritura de un conjunto de problemas en formato binario
+        \pre m es un conjunto de parejas (índice de problema, número de envíos)
+        \post Se ha escrito en f el tamaño de m seguido de sus parejas
+    */
+    static void guardar_problemas(const Mapa_verdes& m, Escritor_binario& f);
+
+    /** @brief Lectura de un conjunto de problemas en formato binario
+        \pre En la posición actual de f hay un conjunto escrito con guardar_problemas
+        \post m contiene las parejas leídas de f
     */
-    void escribir_problemas_enviables_usuario() const;
+    static void cargar_problemas(Mapa_verdes& m, Lector_binario& f);
 };
 #endif
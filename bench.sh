@@ -0,0 +1,38 @@
+#!/bin/sh
+# Prueba de rendimiento de principio a fin (make bench).
+# Genera con generador.exe una carga mezclada y mide cuanto tarda program.exe en procesarla. Despues, para cada tipo de
+# comando, anade a la misma carga N funcionalidades de ese tipo: la diferencia de tiempo dividida por N es lo que cuesta
+# cada una con la plataforma en el estado que ha dejado la mezcla.
+# Variables: CARGA (opciones del generador), N (repeticiones por comando), PROGRAMA (opciones de program.exe).
+
+CARGA=${CARGA:-"--problemas 2000 --sesiones 300 --cursos 50 --sesiones_curso 2 6 --usuarios 20000 --comandos 200000"}
+N=${N:-100000}
+PROGRAMA=${PROGRAMA:-""}
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+
+# tiempo en segundos que tarda program.exe con la entrada $1 (el mejor de tres)
+medir() {
+    mejor=""
+    for i in 1 2 3; do
+        t0=$(date +%s%N)
+        ./program.exe $PROGRAMA < "$1" > /dev/null || exit 1
+        t1=$(date +%s%N)
+        t=$((t1 - t0))
+        if [ -z "$mejor" ] || [ $t -lt $mejor ]; then mejor=$t; fi
+    done
+    awk -v t=$mejor 'BEGIN { printf "%.4f", t/1e9 }'
+}
+
+./generador.exe $CARGA > "$DIR/base.in" || exit 1
+base=$(medir "$DIR/base.in")
+lineas=$(wc -l < "$DIR/base.in")
+echo "carga: $CARGA"
+awk -v t=$base -v l=$lineas 'BEGIN { printf "%-22s %10.4f s %12.0f lineas/s\n", "mezcla", t, l/t }'
+
+for c in envio inscribir_curso curso_usuario escribir_usuario problemas_resueltos problemas_enviables \
+         escribir_problema escribir_sesion escribir_curso sesion_problema problemas_faciles problemas_dificiles problemas_ratio; do
+    ./generador.exe $CARGA --solo $c $N > "$DIR/$c.in" || exit 1
+    t=$(medir "$DIR/$c.in")
+    awk -v c=$c -v t=$t -v b=$base -v n=$N 'BEGIN { d = t - b; if (d <= 0) printf "%-22s  por debajo del ruido (sube N)\n", c; else printf "%-22s %10.4f s %12.0f ops/s %10.3f us/op\n", c, d, n/d, 1e6*d/n }'
+done
@@ -0,0 +1,101 @@
+/** @file bench_contadores.cc
+    @brief Banco de pruebas de los contadores de envíos con varios hilos
+*/
+
+/*
+  Compara dos maneras de contar los envíos que hacen varios hilos a la vez, con una carga sesgada (el 1% de los problemas recibe el 80% de los envíos):
+  - "compartidos": un contador atómico por problema, compartido por todos los hilos (lo que pasaría con un ++ en Problema)
+  - "por hilo": unos Contadores_envios por hilo, aplicados a una Plataforma_material al final (lo que hacen los envíos en paralelo)
+  Para cada número de hilos (1, 2, 4... hasta el máximo) escribe los millones de envíos por segundo de cada manera.
+
+  Uso: bench_contadores.exe [problemas [envios_por_hilo [max_hilos]]]
+*/
+
+#include "Contadores.hh"
+
+#ifndef NO_DIAGRAM
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#endif
+
+/** @brief Genera la secuencia de problemas a los que envía un hilo
+    \pre P >= 100, n >= 0
+    \post v contiene n índices de problema entre 0 y P-1; el 80% de ellos están entre los P/100 primeros
+*/
+void generar_envios(vector<int>& v, int P, int n, unsigned int semilla)
+{
+    unsigned int x = semilla*2654435761u + 1;
+    int calientes = P/100;
+    v.resize(n);
+    for (int i = 0; i < n; ++i) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5; //xorshift
+        if (x%10 < 8) v[i] = (x >> 4)%calientes;
+        else v[i] = calientes + (x >> 4)%(P - calientes);
+    }
+}
+
+/** @brief Envíos de un hilo con contadores compartidos */
+void enviar_compartidos(const vector<int>* envios, vector< atomic<int> >* totales, vector< atomic<int> >* correctos)
+{
+    for (int i = 0; i < envios->size(); ++i) {
+        int p = (*envios)[i];
+        (*totales)[p].fetch_add(1, memory_order_relaxed);
+        if (i%2 == 0) (*correctos)[p].fetch_add(1, memory_order_relaxed);
+    }
+}
+
+/** @brief Envíos de un hilo con sus propios contadores */
+void enviar_por_hilo(const vector<int>* envios, Contadores_envios* contadores)
+{
+    for (int i = 0; i < envios->size(); ++i) contadores->anotar_envio((*envios)[i], i%2 == 0);
+}
+
+/** @brief Segundos transcurridos desde ini */
+double segundos(chrono::steady_clock::time_point ini)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - ini).count();
+}
+
+int main(int argc, char* argv[])
+{
+    int P = argc > 1 ? atoi(argv[1]) : 10000;
+    int n = argc > 2 ? atoi(argv[2]) : 2000000;
+    int max_hilos = argc > 3 ? atoi(argv[3]) : thread::hardware_concurrency();
+    if (P < 100) P = 100;
+    if (max_hilos < 1) max_hilos = 1;
+
+    //la plataforma solo tiene los problemas: es donde se aplican los contadores por hilo
+    Plataforma_material pm;
+    salida.silenciar(true);
+    for (int i = 0; i < P; ++i) pm.nuevo_problema("P" + to_string(i));
+    salida.silenciar(false);
+
+    vector< vector<int> > envios(max_hilos);
+    for (int h = 0; h < max_hilos; ++h) generar_envios(envios[h], P, n, h + 1);
+
+    printf("%d problemas, %d envios por hilo, 80%% de los envios al 1%% de los problemas\n", P, n);
+    printf("%6s %16s %16s\n", "hilos", "compartidos", "por hilo");
+    for (int hilos = 1; hilos <= max_hilos; hilos = hilos < max_hilos and 2*hilos > max_hilos ? max_hilos : 2*hilos) {
+        vector< atomic<int> > totales(P), correctos(P);
+        for (int i = 0; i < P; ++i) totales[i] = correctos[i] = 0;
+        vector<thread> t;
+        chrono::steady_clock::time_point ini = chrono::steady_clock::now();
+        for (int h = 0; h < hilos; ++h) t.push_back(thread(enviar_compartidos, &envios[h], &totales, &correctos));
+        for (int h = 0; h < hilos; ++h) t[h].join();
+        double s_compartidos = segundos(ini);
+
+        vector<Contadores_envios> contadores(hilos);
+        t.clear();
+        ini = chrono::steady_clock::now();
+        for (int h = 0; h < hilos; ++h) t.push_back(thread(enviar_por_hilo, &envios[h], &contadores[h]));
+        for (int h = 0; h < hilos; ++h) t[h].join();
+        for (int h = 0; h < hilos; ++h) contadores[h].aplicar(pm); //incluimos el coste de agregar
+        double s_por_hilo = segundos(ini);
+
+        double total = double(hilos)*n/1e6;
+        printf("%6d %12.1f M/s %12.1f M/s\n", hilos, total/s_compartidos, total/s_por_hilo);
+    }
+}
@@ -0,0 +1,81 @@
+/** @file cliente.cc
+    @brief Cliente de prueba del modo servidor del Evaluator
+*/
+
+/*
+  Uso: cliente.exe ruta espera
+
+  Se conecta al socket local "ruta" de un program.exe en modo servidor y, por la misma conexión (que sigue abierta todo el rato), envía una a una las líneas del canal de entrada. Después de enviar cada línea espera la respuesta: como mucho "espera" milisegundos a que llegue algo, y después lo que siga llegando sin pausas de más de 100 ms. Escribe las respuestas en el canal de salida.
+
+  Si alguna línea no recibe respuesta a tiempo, lo escribe en el canal de error y acaba con código 1.
+*/
+
+#ifndef NO_DIAGRAM
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+using namespace std;
+#endif
+
+/** @brief Envía los n bytes de datos por el socket fd. Retorna false si no se ha podido */
+bool enviar(int fd, const char* datos, size_t n)
+{
+      while (n > 0) {
+            ssize_t enviados = write(fd, datos, n);
+            if (enviados <= 0) return false;
+            datos += enviados;
+            n -= enviados;
+      }
+      return true;
+}
+
+/** @brief Escribe en el canal de salida lo que llega por fd: espera como mucho "espera" ms al primer bloque y 100 ms a cada uno de los siguientes. Retorna false si no ha llegado nada */
+bool recibir(int fd, int espera)
+{
+      bool recibido = false;
+      char buf[1 << 16];
+      pollfd p;
+      p.fd = fd;
+      p.events = POLLIN;
+      while (poll(&p, 1, recibido ? 100 : espera) > 0) {
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n <= 0) break;
+            fwrite(buf, 1, n, stdout);
+            recibido = true;
+      }
+      return recibido;
+}
+
+int main(int argc, char* argv[])
+{
+      if (argc != 3) {
+            fprintf(stderr, "uso: %s ruta espera\n", argv[0]);
+            return 1;
+      }
+      sockaddr_un direccion;
+      memset(&direccion, 0, sizeof(direccion));
+      direccion.sun_family = AF_UNIX;
+      if (strlen(argv[1]) >= sizeof(direccion.sun_path)) return 1;
+      strcpy(direccion.sun_path, argv[1]);
+      int espera = atoi(argv[2]);
+      int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (fd == -1 or connect(fd, (sockaddr*)&direccion, sizeof(direccion)) != 0) {
+            fprintf(stderr, "error: no se puede conectar con %s\n", argv[1]);
+            return 1;
+      }
+      char linea[1 << 16];
+      while (fgets(linea, sizeof(linea), stdin) != NULL) {
+            if (not enviar(fd, linea, strlen(linea)) or not recibir(fd, espera)) {
+                  fprintf(stderr, "error: sin respuesta a %s", linea);
+                  close(fd);
+                  return 1;
+            }
+            fflush(stdout);
+      }
+      close(fd);
+}
@@ -0,0 +1,417 @@
+/** @file generador.cc
+    @brief Generador de cargas sintéticas para el Evaluator
+*/
+
+/*
+  Escribe en el canal de salida una entrada válida para program.exe: la inicialización (problemas, sesiones, cursos y usuarios) seguida de una secuencia de funcionalidades. Para que todos los envíos sean válidos (el problema tiene que ser enviable para el usuario), el generador simula el progreso de cada usuario igual que lo hace la plataforma.
+
+  Opciones (todas con un valor por defecto):
+    --semilla n              semilla del generador de números aleatorios
+    --problemas n            número de problemas
+    --sesiones n             número de sesiones
+    --problemas_sesion n     número de problemas de cada sesión
+    --forma f                forma de los árboles de prerrequisitos: aleatoria, equilibrada o cadena (profundidad máxima)
+    --cursos n               número de cursos
+    --sesiones_curso a b     cada curso tiene entre a y b sesiones (sin problemas repetidos)
+    --usuarios n             número de usuarios
+    --comandos n             número de funcionalidades de la parte mezclada
+    --envios w               peso de envio en la mezcla
+    --inscripciones w        peso de inscribir_curso en la mezcla
+    --consultas w            peso de las consultas en la mezcla (repartido entre todas; los listados completos son 100 veces menos frecuentes)
+    --acierto x              probabilidad de que un envío sea correcto
+    --sesgo s                exponente de la distribución de Zipf con que se eligen usuarios y cursos (0 = uniforme)
+    --solo comando n         después de la mezcla, añade n funcionalidades "comando" (nombre largo)
+*/
+
+#ifndef NO_DIAGRAM
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+using namespace std;
+#endif
+
+/** @brief Generador de números aleatorios (xorshift64*) */
+struct Aleatorio {
+    unsigned long long x;
+
+    /** @brief Siguiente número de 64 bits */
+    unsigned long long siguiente()
+    {
+        x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+        return x*2685821657736338717ULL;
+    }
+    /** @brief Entero uniforme entre 0 y n-1 (n >= 1) */
+    int entero(int n) { return siguiente()%n; }
+    /** @brief Real uniforme entre 0 y 1 */
+    double real() { return (siguiente() >> 11)*(1.0/9007199254740992.0); }
+};
+
+/** @brief Distribución de Zipf sobre n elementos: el elemento i (desde 0) tiene probabilidad proporcional a 1/(i+1)^s */
+struct Zipf {
+    vector<double> acumulada;
+
+    /** @brief Prepara la distribución (con s = 0 es uniforme) */
+    void preparar(int n, double s)
+    {
+        acumulada.resize(n);
+        double suma = 0;
+        for (int i = 0; i < n; ++i) acumulada[i] = suma += pow(i + 1.0, -s);
+        for (int i = 0; i < n; ++i) acumulada[i] /= suma;
+    }
+    /** @brief Elige un elemento */
+    int elegir(Aleatorio& a) const
+    {
+        int i = lower_bound(acumulada.begin(), acumulada.end(), a.real()) - acumulada.begin();
+        return min(i, int(acumulada.size()) - 1);
+    }
+};
+
+/** @brief Nodo de un árbol de prerrequisitos, en preorden (igual que en Sesion) */
+struct Nodo {
+    int problema;
+    int izq;
+    int der;
+};
+
+/** @brief Progreso simulado de un usuario */
+struct Progreso {
+    int curso;
+    unordered_set<int> verdes;
+    vector<int> enviables;
+};
+
+/** @brief Parámetros de la carga */
+struct Parametros {
+    unsigned long long semilla;
+    int problemas, sesiones, problemas_sesion, cursos, min_sesiones, max_sesiones, usuarios, comandos, repeticiones;
+    string forma, solo;
+    double envios, inscripciones, consultas, acierto, sesgo;
+};
+
+/** @brief Salida acumulada (se escribe de golpe al final de cada bloque grande) */
+string out;
+
+/** @brief Escribe el salto de línea y, si la salida acumulada es grande, la vacía */
+void linea()
+{
+    out += '\n';
+    if (out.size() > (1 << 20)) {
+        fwrite(out.data(), 1, out.size(), stdout);
+        out.clear();
+    }
+}
+
+/** @brief Identificador del problema i */
+string id_problema(int i) { return "P" + to_string(i); }
+/** @brief Identificador de la sesión i */
+string id_sesion(int i) { return "S" + to_string(i); }
+/** @brief Identificador del usuario i */
+string id_usuario(int i) { return "u" + to_string(i); }
+
+/** @brief Construye un árbol de prerrequisitos con los problemas ps[ini, fin), en preorden
+    \post Se han añadido los nodos al final de nodos y se retorna la posición de la raíz (-1 si el intervalo es vacío)
+*/
+int construir_arbol(const vector<int>& ps, int ini, int fin, const string& forma, Aleatorio& a, vector<Nodo>& nodos)
+{
+    if (ini == fin) return -1;
+    int i = nodos.size();
+    Nodo n;
+    n.problema = ps[ini];
+    n.izq = n.der = -1;
+    nodos.push_back(n);
+    int resto = fin - ini - 1;
+    int izq; //numero de problemas del subarbol izquierdo
+    if (forma == "cadena") izq = resto;
+    else if (forma == "equilibrada") izq = (resto + 1)/2;
+    else izq = resto == 0 ? 0 : a.entero(resto + 1);
+    int ri = construir_arbol(ps, ini + 1, ini + 1 + izq, forma, a, nodos);
+    int rd = construir_arbol(ps, ini + 1 + izq, fin, forma, a, nodos);
+    nodos[i].izq = ri;
+    nodos[i].der = rd;
+    return i;
+}
+
+/** @brief Escribe un árbol en preorden, con "0" para los subárboles vacíos (el formato que lee Sesion) */
+void escribir_arbol(const vector<Nodo>& nodos, int i)
+{
+    if (i == -1) out += " 0";
+    else {
+        out += ' ';
+        out += id_problema(nodos[i].problema);
+        escribir_arbol(nodos, nodos[i].izq);
+        escribir_arbol(nodos, nodos[i].der);
+    }
+}
+
+/** @brief Añade a los enviables de u los problemas del subárbol i que tiene desbloqueados (igual que Sesion::enviables) */
+void enviables(const vector<Nodo>& nodos, int i, Progreso& u)
+{
+    if (i == -1) return;
+    if (u.verdes.count(nodos[i].problema) == 0) u.enviables.push_back(nodos[i].problema);
+    else {
+        enviables(nodos, nodos[i].izq, u);
+        enviables(nodos, nodos[i].der, u);
+    }
+}
+
+/** @brief Lee las opciones de la línea de comandos
+    \post Retorna false si alguna opción no es válida
+*/
+bool leer_parametros(int argc, char* argv[], Parametros& p)
+{
+    p.semilla = 1;
+    p.problemas = 1000; p.sesiones = 100; p.problemas_sesion = 10; p.forma = "aleatoria";
+    p.cursos = 20; p.min_sesiones = 1; p.max_sesiones = 5; p.usuarios = 10000; p.comandos = 100000;
+    p.envios = 70; p.inscripciones = 10; p.consultas = 20; p.acierto = 0.5; p.sesgo = 1.0;
+    p.repeticiones = 0;
+    for (int i = 1; i < argc; ++i) {
+        string o = argv[i];
+        bool uno = i + 1 < argc, dos = i + 2 < argc;
+        if (o == "--semilla" and uno) p.semilla = strtoull(argv[++i], NULL, 10);
+        else if (o == "--problemas" and uno) p.problemas = atoi(argv[++i]);
+        else if (o == "--sesiones" and uno) p.sesiones = atoi(argv[++i]);
+        else if (o == "--problemas_sesion" and uno) p.problemas_sesion = atoi(argv[++i]);
+        else if (o == "--forma" and uno) p.forma = argv[++i];
+        else if (o == "--cursos" and uno) p.cursos = atoi(argv[++i]);
+        else if (o == "--sesiones_curso" and dos) { p.min_sesiones = atoi(argv[i + 1]); p.max_sesiones = atoi(argv[i + 2]); i += 2; }
+        else if (o == "--usuarios" and uno) p.usuarios = atoi(argv[++i]);
+        else if (o == "--comandos" and uno) p.comandos = atoi(argv[++i]);
+        else if (o == "--envios" and uno) p.envios = atof(argv[++i]);
+        else if (o == "--inscripciones" and uno) p.inscripciones = atof(argv[++i]);
+        else if (o == "--consultas" and uno) p.consultas = atof(argv[++i]);
+        else if (o == "--acierto" and uno) p.acierto = atof(argv[++i]);
+        else if (o == "--sesgo" and uno) p.sesgo = atof(argv[++i]);
+        else if (o == "--solo" and dos) { p.solo = argv[i + 1]; p.repeticiones = atoi(argv[i + 2]); i += 2; }
+        else return false;
+    }
+    if (p.forma != "aleatoria" and p.forma != "equilibrada" and p.forma != "cadena") return false;
+    return p.problemas >= 1 and p.sesiones >= 1 and p.problemas_sesion >= 1 and p.cursos >= 1 and p.usuarios >= 1
+           and p.min_sesiones >= 1 and p.max_sesiones >= p.min_sesiones and p.comandos >= 0 and p.repeticiones >= 0;
+}
+
+/** @brief Estado de la simulación */
+struct Simulacion {
+    Parametros par;
+    Aleatorio a;
+    vector< vector<Nodo> > sesiones;
+    vector< vector<int> > cursos; //sesiones de cada curso (el curso c esta en la posicion c-1)
+    vector< unordered_map<int, pair<int,int> > > ubicacion; //para cada curso, problema -> (sesion, nodo)
+    vector<Progreso> usuarios;
+    vector<int> inscritos; //usuarios inscritos en algun curso
+    vector<int> pos_inscrito; //posicion de cada usuario en "inscritos", -1 si no esta
+    Zipf zipf_usuarios, zipf_cursos;
+};
+
+/** @brief Quita a u de la lista de inscritos (intercambiándolo con el último) */
+void quitar_inscrito(Simulacion& sim, int u)
+{
+    int i = sim.pos_inscrito[u];
+    int ultimo = sim.inscritos.back();
+    sim.inscritos[i] = ultimo;
+    sim.pos_inscrito[ultimo] = i;
+    sim.inscritos.pop_back();
+    sim.pos_inscrito[u] = -1;
+}
+
+/** @brief Escribe una inscripción y la simula */
+void generar_inscripcion(Simulacion& sim)
+{
+    int u = sim.zipf_usuarios.elegir(sim.a);
+    int c = sim.zipf_cursos.elegir(sim.a) + 1;
+    out += "inscribir_curso " + id_usuario(u) + " " + to_string(c);
+    linea();
+    Progreso& pu = sim.usuarios[u];
+    if (pu.curso != 0) return; //la plataforma escribe un error y no cambia nada
+    pu.enviables.clear();
+    const vector<int>& ss = sim.cursos[c-1];
+    for (int i = 0; i < ss.size(); ++i) {
+        if (not sim.sesiones[ss[i]].empty()) enviables(sim.sesiones[ss[i]], 0, pu);
+    }
+    if (not pu.enviables.empty()) {
+        pu.curso = c;
+        sim.pos_inscrito[u] = sim.inscritos.size();
+        sim.inscritos.push_back(u);
+    }
+}
+
+/** @brief Escribe un envío de un usuario inscrito y lo simula
+    \pre completar indica si el envío puede hacer que el usuario complete el curso (si no, el último problema del curso siempre se envía mal y el usuario sigue inscrito)
+    \post Retorna false (sin escribir nada) si no hay ningún usuario inscrito
+*/
+bool generar_envio(Simulacion& sim, bool completar)
+{
+    if (sim.inscritos.empty()) return false;
+    int u = sim.inscritos[sim.a.entero(sim.inscritos.size())];
+    Progreso& pu = sim.usuarios[u];
+    int k = sim.a.entero(pu.enviables.size());
+    int p = pu.enviables[k];
+    bool r = sim.a.real() < sim.par.acierto;
+    if (r) {
+        pu.verdes.insert(p);
+        pu.enviables[k] = pu.enviables.back();
+        pu.enviables.pop_back();
+        pair<int,int> ub = sim.ubicacion[pu.curso-1][p];
+        const vector<Nodo>& nodos = sim.sesiones[ub.first];
+        enviables(nodos, nodos[ub.second].izq, pu);
+        enviables(nodos, nodos[ub.second].der, pu);
+        if (pu.enviables.empty() and not completar) { //lo deshacemos: era el ultimo problema del curso y el envio sera incorrecto
+            pu.verdes.erase(p);
+            pu.enviables.push_back(p);
+            r = false;
+        }
+        else if (pu.enviables.empty()) { //ha completado el curso
+            pu.curso = 0;
+            quitar_inscrito(sim, u);
+        }
+    }
+    out += "envio " + id_usuario(u) + " " + id_problema(p) + (r ? " 1" : " 0");
+    linea();
+    return true;
+}
+
+/** @brief Nombres largos de las consultas que se pueden generar */
+const char* CONSULTAS[] = {
+    "curso_usuario", "escribir_usuario", "problemas_resueltos", "problemas_enviables", "escribir_problema", "escribir_sesion",
+    "escribir_curso", "sesion_problema", "problemas_faciles", "problemas_dificiles", "problemas_ratio",
+    "listar_problemas", "listar_sesiones", "listar_cursos", "listar_usuarios"
+};
+/** @brief Número de consultas, y posición de la primera que es un listado completo */
+const int NUM_CONSULTAS = 15, PRIMER_LISTADO = 11;
+
+/** @brief Escribe una consulta (no cambia el estado simulado)
+    \post Retorna false si el comando no es ninguna consulta conocida
+*/
+bool generar_consulta(Simulacion& sim, const string& comando)
+{
+    int u = sim.zipf_usuarios.elegir(sim.a);
+    if (comando == "curso_usuario" or comando == "escribir_usuario" or comando == "problemas_resueltos") out += comando + " " + id_usuario(u);
+    else if (comando == "problemas_enviables") { //solo tiene sentido para usuarios inscritos
+        if (not sim.inscritos.empty()) u = sim.inscritos[sim.a.entero(sim.inscritos.size())];
+        out += comando + " " + id_usuario(u);
+    }
+    else if (comando == "escribir_problema") out += comando + " " + id_problema(sim.a.entero(sim.par.problemas));
+    else if (comando == "escribir_sesion") out += comando + " " + id_sesion(sim.a.entero(sim.par.sesiones));
+    else if (comando == "escribir_curso") out += comando + " " + to_string(sim.zipf_cursos.elegir(sim.a) + 1);
+    else if (comando == "sesion_problema") out += comando + " " + to_string(sim.zipf_cursos.elegir(sim.a) + 1) + " " + id_problema(sim.a.entero(sim.par.problemas));
+    else if (comando == "problemas_faciles" or comando == "problemas_dificiles") out += comando + " 10";
+    else if (comando == "problemas_ratio") out += comando + " 1 1.5";
+    else if (comando == "listar_problemas" or comando == "listar_sesiones" or comando == "listar_cursos" or comando == "listar_usuarios") out += comando;
+    else return false;
+    linea();
+    return true;
+}
+
+/** @brief Escribe la inicialización de la plataforma y prepara la simulación */
+void generar_inicializacion(Simulacion& sim)
+{
+    const Parametros& par = sim.par;
+    out += to_string(par.problemas);
+    linea();
+    for (int i = 0; i < par.problemas; ++i) {
+        out += id_problema(i);
+        out += i + 1 < par.problemas ? ' ' : '\n';
+    }
+
+    //cada sesion coge problemas_sesion problemas distintos; si hay suficientes, las sesiones no comparten problemas
+    vector<int> orden(par.problemas);
+    for (int i = 0; i < par.problemas; ++i) orden[i] = i;
+    int usados = par.problemas;
+    sim.sesiones.resize(par.sesiones);
+    out += to_string(par.sesiones);
+    linea();
+    for (int s = 0; s < par.sesiones; ++s) {
+        int k = min(par.problemas_sesion, par.problemas);
+        if (usados + k > par.problemas) { //barajamos de nuevo
+            for (int i = par.problemas - 1; i > 0; --i) swap(orden[i], orden[sim.a.entero(i + 1)]);
+            usados = 0;
+        }
+        vector<int> ps(orden.begin() + usados, orden.begin() + usados + k);
+        usados += k;
+        construir_arbol(ps, 0, k, par.forma, sim.a, sim.sesiones[s]);
+        out += id_sesion(s);
+        escribir_arbol(sim.sesiones[s], 0);
+        linea();
+    }
+
+    //cada curso coge sesiones al azar, descartando las que comparten problemas con las que ya tiene (asi el curso siempre es correcto)
+    sim.cursos.resize(par.cursos);
+    sim.ubicacion.resize(par.cursos);
+    out += to_string(par.cursos);
+    linea();
+    for (int c = 0; c < par.cursos; ++c) {
+        int quiere = par.min_sesiones + sim.a.entero(par.max_sesiones - par.min_sesiones + 1);
+        for (int intento = 0; intento < 4*quiere and sim.cursos[c].size() < quiere; ++intento) {
+            int s = sim.a.entero(par.sesiones);
+            const vector<Nodo>& nodos = sim.sesiones[s];
+            bool libre = true;
+            for (int i = 0; i < nodos.size() and libre; ++i) libre = sim.ubicacion[c].count(nodos[i].problema) == 0;
+            if (libre) {
+                sim.cursos[c].push_back(s);
+                for (int i = 0; i < nodos.size(); ++i) sim.ubicacion[c][nodos[i].problema] = make_pair(s, i);
+            }
+        }
+        out += to_string(sim.cursos[c].size());
+        for (int i = 0; i < sim.cursos[c].size(); ++i) out += " " + id_sesion(sim.cursos[c][i]);
+        linea();
+    }
+
+    out += to_string(par.usuarios);
+    linea();
+    for (int u = 0; u < par.usuarios; ++u) {
+        out += id_usuario(u);
+        linea();
+    }
+    sim.usuarios.resize(par.usuarios);
+    for (int u = 0; u < par.usuarios; ++u) sim.usuarios[u].curso = 0;
+    sim.pos_inscrito.assign(par.usuarios, -1);
+    sim.zipf_usuarios.preparar(par.usuarios, par.sesgo);
+    sim.zipf_cursos.preparar(par.cursos, par.sesgo);
+}
+
+int main(int argc, char* argv[])
+{
+    Simulacion sim;
+    if (not leer_parametros(argc, argv, sim.par)) {
+        fprintf(stderr, "uso: %s [--semilla n] [--problemas n] [--sesiones n] [--problemas_sesion n] [--forma aleatoria|equilibrada|cadena] [--cursos n] [--sesiones_curso a b] [--usuarios n] [--comandos n] [--envios w] [--inscripciones w] [--consultas w] [--acierto x] [--sesgo s] [--solo comando n]\n", argv[0]);
+        return 1;
+    }
+    const Parametros& par = sim.par;
+    sim.a.x = par.semilla*0x9E3779B97F4A7C15ULL + 1;
+    generar_inicializacion(sim);
+
+    //parte mezclada: si toca un envio y no hay nadie inscrito, se hace una inscripcion
+    double total = par.envios + par.inscripciones + par.consultas;
+    for (int i = 0; i < par.comandos and total > 0; ++i) {
+        double x = sim.a.real()*total;
+        if (x < par.envios) {
+            if (not generar_envio(sim, true)) generar_inscripcion(sim);
+        }
+        else if (x < par.envios + par.inscripciones) generar_inscripcion(sim);
+        else {
+            int k = sim.a.entero(PRIMER_LISTADO);
+            if (sim.a.entero(100) == 0) k = PRIMER_LISTADO + sim.a.entero(NUM_CONSULTAS - PRIMER_LISTADO);
+            generar_consulta(sim, CONSULTAS[k]);
+        }
+    }
+
+    //parte de un solo comando
+    for (int i = 0; i < par.repeticiones; ++i) {
+        bool ok;
+        if (par.solo == "envio") ok = generar_envio(sim, false); //los usuarios no acaban el curso, asi siempre hay alguien a quien generarle envios
+        else if (par.solo == "inscribir_curso") { generar_inscripcion(sim); ok = true; }
+        else ok = generar_consulta(sim, par.solo);
+        if (not ok) {
+            fprintf(stderr, "error: no se puede generar %s\n", par.solo.c_str());
+            return 1;
+        }
+    }
+    out += "fin";
+    linea();
+    fwrite(out.data(), 1, out.size(), stdout);
+}
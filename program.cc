@@ -5,154 +5,1091 @@
 /**
   * @mainpage Evaluator: plataforma de gestión de problemas y cursos de programación
   En este proyecto he desarrollado un programa que representa una plataforma de gestión de problemas y cursos de programación: "Evaluator".
-  A fin de cubrir los objetivos y las funcionalidades que se nos proponen en el enunciado de la Práctica de Pro2 (primavera 2021), el diseño modular que he planteado para mi práctica consiste en 6 clases:
+  A fin de cubrir los objetivos y las funcionalidades que se nos proponen en el enunciado de la Práctica de Pro2 (primavera 2021), el diseño modular que he planteado para mi práctica consiste en 18 clases:
   <ul>
+  <li> Lector </li>
+  <li> Escritor </li>
+  <li> Escritor_binario, Lector_binario y Fichero_proyectado </li>
+  <li> Registro </li>
+  <li> Region, Asignador_region, Pool y Asignador_pool </li>
+  <li> Tabla_ids </li>
   <li> Problema </li>
   <li> Sesion </li>
+  <li> Mapa_plano </li>
   <li> Curso </li>
   <li> Usuario </li>
   <li> Plataforma_material </li>
+  <li> Contadores_envios </li>
   <li> Plataforma_usuarios </li>
 */
 
 #include "Plataforma_material.hh"
 #include "Plataforma_usuarios.hh"
+#include "Registro.hh"
 
-/** @brief Mediante este programa se podrá realizar por un lado la inicialización del Evaluator y, por otro, las funcionalidades que ofrece la plataforma Evaluator
+#ifndef NO_DIAGRAM
+#include <cstdlib>
+#include <csignal>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+/** @brief Funcionalidades que ofrece la plataforma Evaluator */
+enum Comando {
+      NUEVO_PROBLEMA, NUEVA_SESION, NUEVO_CURSO, ALTA_USUARIO, BAJA_USUARIO, INSCRIBIR_CURSO, CURSO_USUARIO,
+      SESION_PROBLEMA, PROBLEMAS_RESUELTOS, PROBLEMAS_ENVIABLES, ENVIO, LISTAR_PROBLEMAS, ESCRIBIR_PROBLEMA,
+      LISTAR_SESIONES, ESCRIBIR_SESION, LISTAR_CURSOS, ESCRIBIR_CURSO, LISTAR_USUARIOS, ESCRIBIR_USUARIO,
+      PROBLEMAS_FACILES, PROBLEMAS_DIFICILES, PROBLEMAS_RATIO, GUARDAR_ESTADO, ENVIOS_LOTE, ESTADISTICAS, ESTADISTICAS_CURSO, RANKING_CURSO,
+      LISTAR_USUARIOS_PAGINA, LISTAR_PROBLEMAS_PAGINA, LISTAR_SESIONES_PAGINA, BUSCAR_USUARIOS, BUSCAR_PROBLEMAS,
+      INSCRIBIR_CURSO_LOTE, FIN, DESCONOCIDO
+};
+
+/** @brief Nombre largo y nombre corto de cada funcionalidad */
+struct Nombre_comando {
+      const char* largo;
+      const char* corto;
+      Comando comando;
+};
+
+/** @brief Tabla con todos los nombres que acepta el Evaluator */
+const Nombre_comando NOMBRES[] = {
+      {"nuevo_problema", "np", NUEVO_PROBLEMA}, {"nueva_sesion", "ns", NUEVA_SESION}, {"nuevo_curso", "nc", NUEVO_CURSO},
+      {"alta_usuario", "a", ALTA_USUARIO}, {"baja_usuario", "b", BAJA_USUARIO}, {"inscribir_curso", "i", INSCRIBIR_CURSO},
+      {"curso_usuario", "cu", CURSO_USUARIO}, {"sesion_problema", "sp", SESION_PROBLEMA}, {"problemas_resueltos", "pr", PROBLEMAS_RESUELTOS},
+      {"problemas_enviables", "pe", PROBLEMAS_ENVIABLES}, {"envio", "e", ENVIO}, {"listar_problemas", "lp", LISTAR_PROBLEMAS},
+      {"escribir_problema", "ep", ESCRIBIR_PROBLEMA}, {"listar_sesiones", "ls", LISTAR_SESIONES}, {"escribir_sesion", "es", ESCRIBIR_SESION},
+      {"listar_cursos", "lc", LISTAR_CURSOS}, {"escribir_curso", "ec", ESCRIBIR_CURSO}, {"listar_usuarios", "lu", LISTAR_USUARIOS},
+      {"escribir_usuario", "eu", ESCRIBIR_USUARIO}, {"problemas_faciles", "pf", PROBLEMAS_FACILES}, {"problemas_dificiles", "pd", PROBLEMAS_DIFICILES},
+      {"problemas_ratio", "pra", PROBLEMAS_RATIO}, {"guardar_estado", "ge", GUARDAR_ESTADO},
+      {"envios_lote", "el", ENVIOS_LOTE}, {"estadisticas", "est", ESTADISTICAS},
+      {"estadisticas_curso", "esc", ESTADISTICAS_CURSO}, {"ranking_curso", "rc", RANKING_CURSO},
+      {"listar_usuarios_pagina", "lup", LISTAR_USUARIOS_PAGINA}, {"listar_problemas_pagina", "lpp", LISTAR_PROBLEMAS_PAGINA},
+      {"listar_sesiones_pagina", "lsp", LISTAR_SESIONES_PAGINA}, {"buscar_usuarios", "bu", BUSCAR_USUARIOS},
+      {"buscar_problemas", "bp", BUSCAR_PROBLEMAS}, {"inscribir_curso_lote", "il", INSCRIBIR_CURSO_LOTE}, {"fin", "fin", FIN}
+};
+
+/** @brief Número de casillas de la tabla de dispersión de nombres (potencia de 2, más del doble del número de nombres) */
+const int MIDA_TABLA = 256;
+
+/** @brief Casilla de la tabla de dispersión de nombres */
+struct Casilla {
+      const char* nombre;
+      Comando comando;
+};
+
+/** @brief Tabla de dispersión (con direccionamiento abierto) que asocia cada nombre a su funcionalidad */
+Casilla tabla_comandos[MIDA_TABLA];
+
+/** @brief Función de dispersión (FNV-1a) de una secuencia de caracteres
+    \pre s apunta a n caracteres
+    \post Retorna el valor de dispersión de los n caracteres
 */
+unsigned int dispersion(const char* s, int n)
+{
+      unsigned int h = 2166136261u;
+      for (int i = 0; i < n; ++i) h = (h ^ (unsigned char)s[i]) * 16777619u;
+      return h;
+}
 
-int main()
+/** @brief Construye la tabla de dispersión de nombres
+    \pre <em>cierto</em>
+    \post tabla_comandos contiene todos los nombres (largos y cortos) de NOMBRES
+*/
+void inicializar_comandos()
 {
-      //inicializamos la Plataforma Evaluator
-      Plataforma_material Evaluator_material;
-      Plataforma_usuarios Evaluator_usuarios;
+      int n = sizeof(NOMBRES)/sizeof(NOMBRES[0]);
+      for (int i = 0; i < 2*n; ++i) {
+            const char* nombre = i%2 == 0 ? NOMBRES[i/2].largo : NOMBRES[i/2].corto;
+            unsigned int h = dispersion(nombre, strlen(nombre)) & (MIDA_TABLA - 1);
+            while (tabla_comandos[h].nombre != NULL and strcmp(tabla_comandos[h].nombre, nombre) != 0) h = (h + 1) & (MIDA_TABLA - 1);
+            tabla_comandos[h].nombre = nombre;
+            tabla_comandos[h].comando = NOMBRES[i/2].comando;
+      }
+}
 
-      //leemos los problemas para la inicializacion
-      Evaluator_material.leer_cj_problemas();
+/** @brief Identifica la funcionalidad que corresponde a una palabra
+    \pre t es una palabra del canal de entrada, inicializar_comandos() ya se ha ejecutado
+    \post Retorna la funcionalidad cuyo nombre (largo o corto) es t, o DESCONOCIDO si no hay ninguna. Si la hay, nombre apunta a su nombre tal y como se ha escrito
+    \coste Lineal en la longitud de t
+*/
+Comando identificar_comando(const Token& t, const char*& nombre)
+{
+      unsigned int h = dispersion(t.ini, t.mida) & (MIDA_TABLA - 1);
+      while (tabla_comandos[h].nombre != NULL) {
+            if (t.es(tabla_comandos[h].nombre)) {
+                  nombre = tabla_comandos[h].nombre;
+                  return tabla_comandos[h].comando;
+            }
+            h = (h + 1) & (MIDA_TABLA - 1);
+      }
+      return DESCONOCIDO;
+}
 
-      //leemos las sesiones para la inicializacion
-      Evaluator_material.leer_cj_sesiones();
+/** @brief Número de funcionalidades que se miden (todas menos DESCONOCIDO) */
+const int NUM_COMANDOS = DESCONOCIDO;
 
-      //leemos los cursos para la inicializacion
-      Evaluator_material.leer_cj_cursos();
+/** @brief Número de cubetas de los histogramas de latencia: la cubeta i cuenta las latencias de entre 2^i y 2^(i+1) - 1 nanosegundos (la última, también todas las mayores) */
+const int CUBETAS = 40;
 
-      //leemos los usuarios para la inicializacion
-      Evaluator_usuarios.leer_cj_usuarios();
+/** @brief Cada cuántas ejecuciones de una funcionalidad se mide su latencia (el resto solo se cuentan) */
+int muestreo = 8;
 
-      //ya tenemos la plataforma inicializada. A continuación leemos y executamos las funcionalidades
-      string funcion;
-      while (cin >> funcion and funcion != "fin") {
-            if (funcion == "nuevo_problema" or funcion == "np") {
-                  string p;
-                  cin >> p;
-                  cout << "#" << funcion << " " << p << endl;
-                  Evaluator_material.nuevo_problema(p);
-            }
-            else if (funcion == "nueva_sesion" or funcion == "ns") {
-                  string s;
-                  cin >> s;
-                  cout << "#" << funcion << " " << s << endl;
-                  Evaluator_material.nueva_sesion(s);
+/** @brief Suma relaxed de d a un contador que solo escribe un hilo (sin instrucción atómica de lectura-modificación-escritura) */
+inline void incrementar(atomic<long long>& x, long long d)
+{
+      x.store(x.load(memory_order_relaxed) + d, memory_order_relaxed);
+}
+
+/** @brief Instante actual en nanosegundos (reloj monótono) */
+inline long long ahora()
+{
+      return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/** @class Medidas_hilo
+    @brief Representa las medidas de las funcionalidades que ha ejecutado un hilo: cuántas veces se ha ejecutado cada una y, de las ejecuciones medidas, el tiempo total y el histograma de latencias.
+
+    Solo escribe en ellas el propio hilo, así que anotar una funcionalidad no necesita ningún cerrojo ni ninguna instrucción atómica cara: los contadores son atómicos únicamente para que otro hilo los pueda leer mientras tanto (ver Estadisticas). Para que medir tampoco cueste, solo se consulta el reloj en una de cada "muestreo" ejecuciones de cada funcionalidad.
+*/
+class Medidas_hilo
+{
+public:
+      /** @brief Número de ejecuciones de cada funcionalidad */
+      atomic<long long> veces[NUM_COMANDOS];
+      /** @brief Número de ejecuciones medidas de cada funcionalidad */
+      atomic<long long> medidas[NUM_COMANDOS];
+      /** @brief Suma de las latencias medidas de cada funcionalidad, en nanosegundos */
+      atomic<long long> tiempo[NUM_COMANDOS];
+      /** @brief Histograma de las latencias medidas de cada funcionalidad */
+      atomic<long long> histograma[NUM_COMANDOS][CUBETAS];
+
+      /** @brief Creadora: las medidas empiezan a cero y el hilo las registra en "estadisticas" */
+      Medidas_hilo();
+
+      /** @brief Destructora: suma las medidas del hilo a las de los hilos acabados de "estadisticas" */
+      ~Medidas_hilo();
+
+      /** @brief Anota que empieza una ejecución de la funcionalidad c
+          \pre <em>cierto</em>
+          \post Se ha contado la ejecución. Retorna el instante en que empieza si toca medirla, o -1 si no (o si c es DESCONOCIDO)
+      */
+      long long empezar(Comando c)
+      {
+            if (c == DESCONOCIDO) return -1;
+            incrementar(veces[c], 1);
+            if (--hasta_medida[c] > 0) return -1;
+            hasta_medida[c] = muestreo;
+            return ahora();
+      }
+
+      /** @brief Anota que acaba la ejecución de la funcionalidad c
+          \pre inicio es lo que ha retornado empezar(c) al empezarla
+          \post Si la ejecución se medía, se ha sumado su latencia al tiempo y al histograma de c
+      */
+      void acabar(Comando c, long long inicio)
+      {
+            if (inicio == -1) return;
+            long long ns = ahora() - inicio;
+            int cubeta = ns <= 0 ? 0 : min(63 - __builtin_clzll(ns), CUBETAS - 1);
+            incrementar(medidas[c], 1);
+            incrementar(tiempo[c], ns);
+            incrementar(histograma[c][cubeta], 1);
+      }
+
+private:
+      /** @brief Cuántas ejecuciones de cada funcionalidad faltan para la siguiente que se mide */
+      int hasta_medida[NUM_COMANDOS];
+
+      /** @brief Los objetos no se pueden copiar */
+      Medidas_hilo(const Medidas_hilo&);
+      Medidas_hilo& operator=(const Medidas_hilo&);
+};
+
+/** @brief Suma de las medidas de varios hilos */
+struct Suma_medidas {
+      long long veces[NUM_COMANDOS];
+      long long medidas[NUM_COMANDOS];
+      long long tiempo[NUM_COMANDOS];
+      long long histograma[NUM_COMANDOS][CUBETAS];
+
+      /** @brief Creadora: la suma empieza a cero */
+      Suma_medidas() { memset(this, 0, sizeof(*this)); }
+
+      /** @brief Suma las medidas de un hilo (que pueden estar cambiando mientras tanto) */
+      void sumar(const Medidas_hilo& h)
+      {
+            for (int c = 0; c < NUM_COMANDOS; ++c) {
+                  veces[c] += h.veces[c].load(memory_order_relaxed);
+                  medidas[c] += h.medidas[c].load(memory_order_relaxed);
+                  tiempo[c] += h.tiempo[c].load(memory_order_relaxed);
+                  for (int i = 0; i < CUBETAS; ++i) histograma[c][i] += h.histograma[c][i].load(memory_order_relaxed);
             }
+      }
+};
+
+/** @brief Medidas de todo el programa: las de los hilos vivos, que se suman al consultarlas, y la suma de las de los hilos que ya han acabado */
+struct Estadisticas {
+      mutex m;
+      vector<Medidas_hilo*> vivas;
+      Suma_medidas acabadas;
+
+      /** @brief Retorna la suma de las medidas de todos los hilos */
+      Suma_medidas consultar()
+      {
+            lock_guard<mutex> cerrado(m);
+            Suma_medidas s = acabadas;
+            for (int i = 0; i < vivas.size(); ++i) s.sumar(*vivas[i]);
+            return s;
+      }
+};
+
+/** @brief Medidas de todo el programa */
+Estadisticas estadisticas;
+
+/** @brief Medidas de las funcionalidades que ejecuta cada hilo */
+thread_local Medidas_hilo medidas_hilo;
+
+Medidas_hilo::Medidas_hilo()
+{
+      //cada hilo empieza a medir en un punto distinto del ciclo de muestreo: si todos midieran su primera ejecucion, los hilos que ejecutan pocas funcionalidades (los de conexiones cortas) se medirian de mas
+      static atomic<int> hilos_creados(0);
+      int desfase = hilos_creados++;
+      for (int c = 0; c < NUM_COMANDOS; ++c) {
+            veces[c] = medidas[c] = tiempo[c] = 0;
+            for (int i = 0; i < CUBETAS; ++i) histograma[c][i] = 0;
+            hasta_medida[c] = 1 + (desfase + c)%muestreo;
+      }
+      lock_guard<mutex> cerrado(estadisticas.m);
+      estadisticas.vivas.push_back(this);
+}
 
-            else if (funcion == "nuevo_curso" or funcion == "nc") {
-                  cout << "#" << funcion << endl;
-                  Evaluator_material.nuevo_curso();
+Medidas_hilo::~Medidas_hilo()
+{
+      lock_guard<mutex> cerrado(estadisticas.m);
+      estadisticas.acabadas.sumar(*this);
+      estadisticas.vivas.erase(find(estadisticas.vivas.begin(), estadisticas.vivas.end(), this));
+}
+
+/** @brief Cota superior de un percentil de latencia
+    \pre h es un histograma con n medidas (n > 0), 0 <= q <= 1
+    \post Retorna el final de la cubeta de h en que está el percentil q de las medidas (el percentil es menor que este valor, en nanosegundos)
+*/
+long long percentil(const long long* h, long long n, double q)
+{
+      long long acumuladas = 0;
+      int i = 0;
+      while (i < CUBETAS - 1 and (acumuladas += h[i]) < q*n) ++i;
+      return 1LL << (i + 1);
+}
+
+/** @brief Escribe las medidas de todas las funcionalidades que se han ejecutado
+    \pre <em>cierto</em>
+    \post Se ha escrito en el canal de salida, para cada funcionalidad ejecutada alguna vez (en el orden de NOMBRES), cuántas veces se ha ejecutado y cuántas se han medido, la latencia media, el tiempo total estimado, las cotas de los percentiles 50, 90 y 99 y del máximo, y el histograma (el inicio de cada cubeta no vacía en nanosegundos y el número de medidas que tiene)
+*/
+void escribir_estadisticas()
+{
+      Suma_medidas s = estadisticas.consultar();
+      int n = sizeof(NOMBRES)/sizeof(NOMBRES[0]);
+      for (int k = 0; k < n; ++k) {
+            Comando c = NOMBRES[k].comando;
+            if (c == FIN or s.veces[c] == 0) continue;
+            salida << NOMBRES[k].largo << ": " << s.veces[c] << " ejecuciones, " << s.medidas[c] << " medidas";
+            if (s.medidas[c] > 0) {
+                  long long media = s.tiempo[c]/s.medidas[c];
+                  salida << ", media " << media << " ns, total " << media*s.veces[c]/1000 << " us, p50 < " << percentil(s.histograma[c], s.medidas[c], 0.5)
+                         << " ns, p90 < " << percentil(s.histograma[c], s.medidas[c], 0.9) << " ns, p99 < " << percentil(s.histograma[c], s.medidas[c], 0.99)
+                         << " ns, max < " << percentil(s.histograma[c], s.medidas[c], 1) << " ns" << '\n';
+                  salida << "  histograma:";
+                  for (int i = 0; i < CUBETAS; ++i) {
+                        if (s.histograma[c][i] > 0) salida << " " << (1LL << i) << ":" << s.histograma[c][i];
+                  }
             }
+            salida << '\n';
+      }
+}
+
+/** @brief Confirma las anotaciones pendientes del registro, si hay registro
+    \pre registro es NULL o tiene un fichero abierto
+    \post Si registro no es NULL, se han confirmado sus anotaciones pendientes. Si no se han podido escribir en el disco, se ha escrito un error en el canal de error y se ha acabado el programa sin vaciar el canal de salida: las respuestas de funcionalidades que no han quedado en el registro no se llegan a escribir
+*/
+void confirmar_registro(Registro* registro)
+{
+      if (registro != NULL and not registro->confirmar()) {
+            fprintf(stderr, "error: no se puede escribir el registro\n");
+            _exit(1);
+      }
+}
+
+/** @brief Marca con la que empiezan los ficheros de estado */
+const char MARCA_ESTADO[8] = {'E','V','A','L','U','A','T','R'};
+
+/** @brief Guarda el estado de la plataforma en un fichero binario
+    \pre pm y pu son las plataformas de material y de usuarios del Evaluator, lsn es el lsn de la siguiente anotación del registro (0 si no hay registro)
+    \post Retorna true si se ha podido escribir el fichero "nombre" con la marca, la versión del formato, lsn, el contenido de pm y pu y la suma de comprobación de todo lo anterior. El fichero se escribe primero con otro nombre, se sincroniza con el disco y después se renombra (sincronizando también el directorio), de manera que ni siquiera si el sistema se interrumpe queda a medias
+*/
+bool guardar_estado(const string& nombre, const Plataforma_material& pm, const Plataforma_usuarios& pu, long long lsn)
+//sin sincronizar el fichero antes de renombrarlo, despues de una caida el nombre nuevo podria apuntar a un fichero vacio, y el lsn que contiene daria por cubierto un trozo del registro
+{
+      string temporal = nombre + ".tmp";
+      FILE* fichero = fopen(temporal.c_str(), "wb");
+      if (fichero == NULL) return false;
+      Escritor_binario f(fichero);
+      f.escribir_bytes(MARCA_ESTADO, sizeof(MARCA_ESTADO));
+      f.escribir_entero(VERSION_ESTADO);
+      f.escribir_entero_largo(lsn);
+      pm.guardar(f);
+      pu.guardar(f);
+      unsigned int suma = f.consultar_suma();
+      f.escribir_bytes(&suma, sizeof(suma));
+      bool ok = not f.fallo() and fflush(fichero) == 0 and fsync(fileno(fichero)) == 0;
+      if (fclose(fichero) != 0) ok = false;
+      if (ok) ok = rename(temporal.c_str(), nombre.c_str()) == 0;
+      if (not ok) {
+            remove(temporal.c_str());
+            return false;
+      }
+      return sincronizar_directorio(nombre);
+}
+
+/** @brief Carga el estado de la plataforma de un fichero binario
+    \pre pm y pu están vacías
+    \post Retorna true si el fichero "nombre" existe, tiene la marca, la versión y la suma de comprobación correctas y se ha podido leer entero. En tal caso, pm y pu pasan a tener el contenido del fichero, y lsn el lsn del registro en el momento de guardarlo
+
+    El fichero se proyecta en memoria, pero su contenido se copia a las estructuras de pm y pu (que tienen punteros y contenedores propios), así que el coste es lineal en el tamaño del estado. Antes de leer nada se comprueba la suma: así un fichero corrupto no llega a cargarse a medias, y ningún número de elementos incorrecto llega a utilizarse
+*/
+bool cargar_estado(const string& nombre, Plataforma_material& pm, Plataforma_usuarios& pu, long long& lsn)
+{
+      Fichero_proyectado fichero;
+      if (not fichero.abrir(nombre)) return false;
+      size_t mida = fichero.consultar_mida();
+      unsigned int suma;
+      if (mida < sizeof(suma)) return false;
+      mida -= sizeof(suma);
+      memcpy(&suma, fichero.consultar_datos() + mida, sizeof(suma));
+      if (suma != suma_comprobacion(fichero.consultar_datos(), mida)) return false;
+      Lector_binario f(fichero.consultar_datos(), mida);
+      char marca[sizeof(MARCA_ESTADO)];
+      f.leer_bytes(marca, sizeof(marca));
+      if (memcmp(marca, MARCA_ESTADO, sizeof(marca)) != 0 or f.leer_entero() != VERSION_ESTADO) return false;
+      lsn = f.leer_entero_largo();
+      pm.cargar(f);
+      pu.cargar(f, pm);
+      return not f.fallo();
+}
+
+/** @brief Consulta si una funcionalidad modifica la plataforma (y por lo tanto se tiene que anotar en el registro)
+    \pre <em>cierto</em>
+    \post Retorna true si el comando modifica la plataforma de material o la de usuarios
+*/
+bool es_modificadora(Comando comando)
+{
+      switch (comando) {
+      case NUEVO_PROBLEMA: case NUEVA_SESION: case NUEVO_CURSO: case ALTA_USUARIO:
+      case BAJA_USUARIO: case INSCRIBIR_CURSO: case ENVIO: case ENVIOS_LOTE: case INSCRIBIR_CURSO_LOTE:
+            return true;
+      default:
+            return false;
+      }
+}
+
+/** @brief Funcionalidad que se puede ejecutar en paralelo con otras, leída del canal de entrada con todos sus parámetros */
+struct Orden {
+      Comando comando;
+      const char* funcion;
+      string u, p, s;
+      int c;
+      bool r;
+};
+
+/** @brief Número máximo de funcionalidades que se acumulan en un tramo antes de ejecutarlas */
+const int MAX_TRAMO = 4096;
+
+/** @brief Consulta si una funcionalidad se puede ejecutar en paralelo con otras
+    \pre <em>cierto</em>
+    \post Retorna true si el comando solo consulta o modifica un usuario (sin darlo de alta ni de baja, y sin consultar los stats de problemas y cursos, que los envíos modifican), o solo consulta sesiones (que no cambian al ejecutar ninguno de estos comandos)
+*/
+bool es_fragmentable(Comando comando)
+{
+      switch (comando) {
+      case CURSO_USUARIO: case PROBLEMAS_RESUELTOS: case PROBLEMAS_ENVIABLES: case ENVIO: case ESCRIBIR_USUARIO:
+      case SESION_PROBLEMA: case LISTAR_SESIONES: case ESCRIBIR_SESION:
+            return true;
+      default:
+            return false;
+      }
+}
 
-            else if (funcion == "alta_usuario" or funcion == "a") {
-                  string u;
-                  cin >> u;
-                  cout << "#" << funcion << " " << u << endl;
-                  Evaluator_usuarios.alta_usuario(u);
+/** @brief Lee los parámetros de una funcionalidad fragmentable
+    \pre es_fragmentable(o.comando), el canal de entrada está justo detrás del nombre de la funcionalidad
+    \post o contiene los parámetros de la funcionalidad, leídos del canal de entrada
+*/
+void leer_orden(Orden& o)
+{
+      switch (o.comando) {
+      case CURSO_USUARIO: case PROBLEMAS_RESUELTOS: case PROBLEMAS_ENVIABLES: case ESCRIBIR_USUARIO:
+            entrada >> o.u;
+            break;
+      case ENVIO:
+            entrada >> o.u >> o.p >> o.r;
+            break;
+      case SESION_PROBLEMA:
+            entrada >> o.c >> o.p;
+            break;
+      case ESCRIBIR_SESION:
+            entrada >> o.s;
+            break;
+      default:
+            break;
+      }
+}
+
+/** @brief Ejecuta una funcionalidad fragmentable
+    \pre es_fragmentable(o.comando) y o tiene sus parámetros. Si cambios no es NULL, ningún otro hilo trata el usuario de o y nadie modifica pm mientras tanto
+    \post Se ha escrito en el canal de salida (del hilo) el resultado de la funcionalidad. Si cambios es NULL, se ha ejecutado sobre pm y pu; si no, los cambios que le tocaban a pm se han anotado en los contadores *cambios en lugar de hacerse
+*/
+void ejecutar_orden(const Orden& o, Plataforma_material& pm, Plataforma_usuarios& pu, Contadores_envios* cambios)
+{
+      long long inicio = medidas_hilo.empezar(o.comando);
+      switch (o.comando) {
+      case CURSO_USUARIO:
+            salida << "#" << o.funcion << " " << o.u << '\n';
+            pu.curso_usuario(o.u);
+            break;
+      case SESION_PROBLEMA: {
+            salida << "#" << o.funcion << " " << o.c << " " << o.p << '\n';
+            string sesion = pm.sesion_problema(o.c, o.p);
+            if (sesion != "0") salida << sesion << '\n';
+            break;
+      }
+      case PROBLEMAS_RESUELTOS:
+            salida << "#" << o.funcion << " " << o.u << '\n';
+            pu.problemas_resueltos(o.u, pm);
+            break;
+      case PROBLEMAS_ENVIABLES:
+            salida << "#" << o.funcion << " " << o.u << '\n';
+            pu.problemas_enviables(o.u, pm);
+            break;
+      case ENVIO:
+            salida << "#" << o.funcion << " " << o.u << " " << o.p << " " << o.r << '\n';
+            if (cambios == NULL) pu.envio(o.u, o.p, o.r, pm);
+            else pu.envio_diferido(o.u, o.p, o.r, pm, *cambios);
+            break;
+      case LISTAR_SESIONES:
+            salida << "#" << o.funcion << '\n';
+            pm.listar_sesiones();
+            break;
+      case ESCRIBIR_SESION:
+            salida << "#" << o.funcion << " " << o.s << '\n';
+            pm.escribir_sesion(o.s);
+            break;
+      case ESCRIBIR_USUARIO:
+            salida << "#" << o.funcion << " " << o.u << '\n';
+            pu.escribir_usuario(o.u);
+            break;
+      default:
+            break;
+      }
+      medidas_hilo.acabar(o.comando, inicio);
+}
+
+/** @class Trabajadores_tramo
+    @brief Representa los hilos que ejecutan los tramos de funcionalidades fragmentables, uno por fragmento.
+
+    Los hilos se crean una sola vez, con el objeto, y esperan parados hasta que les llega un tramo. Para cada tramo, cada hilo recibe la lista de las posiciones de las funcionalidades de su fragmento, así que no tiene que recorrer las de los demás, y el hilo que reparte el tramo espera a que acaben todos los que han recibido alguna.
+*/
+class Trabajadores_tramo
+{
+public:
+      /** @brief Creadora: pone en marcha un hilo por fragmento, que trabajará sobre pm y pu
+          \pre fragmentos >= 0
+          \post Hay "fragmentos" hilos esperando tramos
+      */
+      Trabajadores_tramo(int fragmentos, Plataforma_material& pm, Plataforma_usuarios& pu);
+
+      /** @brief Destructora: acaba los hilos y espera a que terminen */
+      ~Trabajadores_tramo();
+
+      /** @brief Consulta el número de fragmentos (y de hilos) */
+      int fragmentos() const { return hilos.size(); }
+
+      /** @brief Ejecuta en paralelo un tramo de funcionalidades fragmentables
+          \pre Las n primeras posiciones de tramo tienen funcionalidades fragmentables, en el orden de la entrada. cambios tiene un contador por fragmento. Nadie más usa la plataforma mientras tanto
+          \post Se han ejecutado las n funcionalidades y se ha escrito su resultado en el canal de salida, en el orden de la entrada. Las funcionalidades de cada usuario las ha ejecutado, en orden, el hilo de su fragmento; las de sesiones se han repartido entre todos. Los cambios que tocaban a pm se han anotado en el contador del fragmento que las ha ejecutado
+      */
+      void ejecutar(const vector<Orden>& tramo, int n, vector<Contadores_envios>& cambios);
+
+private:
+      /** @brief Lo que necesita cada hilo: las posiciones de las funcionalidades de su fragmento en el tramo actual, si tiene que ejecutarlas y dónde se le avisa */
+      struct Trabajador {
+            vector<int> cola;
+            bool pendiente;
+            condition_variable despertar;
+      };
+
+      Plataforma_material& pm;
+      Plataforma_usuarios& pu;
+      /** @brief Protege pendiente, activos y acabar */
+      mutex m;
+      /** @brief Avisa al hilo que reparte el tramo cuando activos llega a 0 */
+      condition_variable hecho;
+      /** @brief Número de hilos que aún no han acabado su parte del tramo */
+      int activos;
+      /** @brief Indica a los hilos que tienen que acabar */
+      bool acabar;
+      vector<Trabajador> trabajadores;
+      vector<thread> hilos;
+      /** @brief Tramo actual y contadores en los que anota los cambios cada fragmento */
+      const vector<Orden>* tramo;
+      vector<Contadores_envios>* cambios;
+      /** @brief Resultado de cada funcionalidad del tramo actual (los strings se vacían después de escribirlos, pero conservan su memoria) */
+      vector<string> resultados;
+
+      /** @brief Bucle del hilo del fragmento f: espera un tramo, ejecuta las funcionalidades de su cola y avisa, hasta que tiene que acabar */
+      void trabajar(int f);
+
+      /** @brief Los objetos no se pueden copiar */
+      Trabajadores_tramo(const Trabajadores_tramo&);
+      Trabajadores_tramo& operator=(const Trabajadores_tramo&);
+};
+
+Trabajadores_tramo::Trabajadores_tramo(int fragmentos, Plataforma_material& pm, Plataforma_usuarios& pu)
+      : pm(pm), pu(pu), activos(0), acabar(false), trabajadores(fragmentos), tramo(NULL), cambios(NULL)
+{
+      for (int f = 0; f < fragmentos; ++f) {
+            trabajadores[f].pendiente = false;
+            hilos.push_back(thread(&Trabajadores_tramo::trabajar, this, f));
+      }
+}
+
+Trabajadores_tramo::~Trabajadores_tramo()
+{
+      {
+            lock_guard<mutex> cerrado(m);
+            acabar = true;
+            for (int f = 0; f < trabajadores.size(); ++f) trabajadores[f].despertar.notify_one();
+      }
+      for (int f = 0; f < hilos.size(); ++f) hilos[f].join();
+}
+
+void Trabajadores_tramo::trabajar(int f)
+{
+      Trabajador& t = trabajadores[f];
+      unique_lock<mutex> cerrado(m);
+      while (true) {
+            while (not t.pendiente and not acabar) t.despertar.wait(cerrado);
+            if (not t.pendiente) return;
+            cerrado.unlock();
+            for (int i = 0; i < t.cola.size(); ++i) {
+                  int k = t.cola[i];
+                  salida.desviar(&resultados[k]);
+                  ejecutar_orden((*tramo)[k], pm, pu, &(*cambios)[f]);
+                  salida.vaciar();
             }
-            else if (funcion == "baja_usuario" or funcion == "b") {
-                  string u;
-                  cin >> u;
-                  cout << "#" << funcion << " " << u << endl;
-                  Evaluator_usuarios.baja_usuario(u, Evaluator_material);
+            salida.desviar(NULL);
+            cerrado.lock();
+            t.pendiente = false;
+            if (--activos == 0) hecho.notify_one();
+      }
+}
+
+void Trabajadores_tramo::ejecutar(const vector<Orden>& tramo, int n, vector<Contadores_envios>& cambios)
+{
+      int fragmentos = hilos.size();
+      for (int f = 0; f < fragmentos; ++f) trabajadores[f].cola.clear();
+      for (int k = 0; k < n; ++k) {
+            Comando comando = tramo[k].comando;
+            bool de_usuario = comando != SESION_PROBLEMA and comando != LISTAR_SESIONES and comando != ESCRIBIR_SESION;
+            int f = de_usuario ? Plataforma_usuarios::fragmento_usuario(tramo[k].u, fragmentos) : k % fragmentos;
+            trabajadores[f].cola.push_back(k);
+      }
+      if (resultados.size() < n) resultados.resize(n);
+      {
+            unique_lock<mutex> cerrado(m);
+            this->tramo = &tramo;
+            this->cambios = &cambios;
+            for (int f = 0; f < fragmentos; ++f) {
+                  if (not trabajadores[f].cola.empty()) {
+                        trabajadores[f].pendiente = true;
+                        ++activos;
+                        trabajadores[f].despertar.notify_one();
+                  }
             }
-            else if (funcion == "inscribir_curso" or funcion == "i") {
-                  string u;
-                  int c;
-                  cin >> u >> c;
-                  cout << "#" << funcion << " " << u << " " << c << endl;
-                  Evaluator_usuarios.inscribir_curso(u,c,Evaluator_material);
+            while (activos > 0) hecho.wait(cerrado);
+      }
+      for (int k = 0; k < n; ++k) {
+            salida << resultados[k];
+            resultados[k].clear();
+      }
+}
+
+/** @brief Ejecuta un tramo de funcionalidades fragmentables
+    \pre Las n primeras posiciones de tramo tienen funcionalidades fragmentables, en el orden de la entrada. Si n > 0, trabajadores no es NULL y cambios tiene un contador por fragmento
+    \post Se han ejecutado las n funcionalidades y se ha escrito su resultado en el canal de salida, en el orden de la entrada (en paralelo con trabajadores, ver Trabajadores_tramo::ejecutar). pu queda igual que si se hubieran ejecutado una a una, y lo que tocaba sumar a pm se ha anotado en el contador de cada fragmento (ver aplicar_contadores). n pasa a ser 0
+*/
+void ejecutar_tramo(const vector<Orden>& tramo, int& n, vector<Contadores_envios>& cambios, Trabajadores_tramo* trabajadores, Plataforma_material& pm, Plataforma_usuarios& pu)
+{
+      if (n == 0) return;
+      if (n == 1) { //no vale la pena despertar ningun hilo, pero los cambios van al contador del fragmento, detras de los que ya tenga pendientes el usuario
+            ejecutar_orden(tramo[0], pm, pu, &cambios[Plataforma_usuarios::fragmento_usuario(tramo[0].u, cambios.size())]);
+      }
+      else trabajadores->ejecutar(tramo, n, cambios);
+      n = 0;
+}
+
+/** @brief Consulta si una funcionalidad consulta los stats de los problemas o de los cursos
+    \pre <em>cierto</em>
+    \post Retorna true si el resultado del comando depende de los envíos de algún problema, de los inscritos o completados de algún curso, de los contadores de sus problemas o de su clasificación (y por lo tanto, antes de ejecutarlo hay que aplicar los contadores pendientes). También baja_usuario (los envíos pendientes de un usuario apuntan a su identificador, que se borra con él) y envios_lote (que mueve directamente los puestos de la clasificación, así que los envíos anteriores tienen que estar aplicados)
+*/
+bool consulta_stats(Comando comando)
+{
+      switch (comando) {
+      case BAJA_USUARIO: case INSCRIBIR_CURSO: case INSCRIBIR_CURSO_LOTE: case ENVIOS_LOTE: case LISTAR_PROBLEMAS: case ESCRIBIR_PROBLEMA:
+      case LISTAR_CURSOS: case ESCRIBIR_CURSO: case PROBLEMAS_FACILES: case PROBLEMAS_DIFICILES: case PROBLEMAS_RATIO: case GUARDAR_ESTADO:
+      case ESTADISTICAS_CURSO: case RANKING_CURSO: case LISTAR_PROBLEMAS_PAGINA: case BUSCAR_PROBLEMAS:
+            return true;
+      default:
+            return false;
+      }
+}
+
+/** @brief Aplica a la plataforma de material los contadores de todos los fragmentos
+    \pre Los contadores se han anotado a partir de envíos hechos sobre pm
+    \post pm queda igual que si los envíos anotados se hubieran hecho uno a uno, y los contadores quedan vacíos
+*/
+void aplicar_contadores(vector<Contadores_envios>& cambios, Plataforma_material& pm)
+//el resto de cambios que se hacen a pm (bajas, lotes de envios...) son sumas y restas que no dependen del orden, asi que no importa que los contadores se apliquen tarde
+//los envios de cada usuario mueven su puesto en la clasificacion de su curso, que si depende del orden: siempre se anotan en el contador de su fragmento, y en orden
+{
+      for (int f = 0; f < cambios.size(); ++f) {
+            if (not cambios[f].vacio()) cambios[f].aplicar(pm);
+      }
+}
+
+/** @class Cerrojo
+    @brief Representa un cerrojo de lectores y escritores, que protege la plataforma cuando la usan varias conexiones a la vez.
+
+    Las funcionalidades que solo consultan la plataforma se ejecutan a la vez (bloqueo compartido), y las que la modifican de una en una (bloqueo exclusivo). Así cada funcionalidad ve la plataforma tal y como la han dejado las modificaciones anteriores, nunca a medias. Cuando hay una modificación esperando, las consultas nuevas esperan detrás de ella, de manera que una serie de consultas no puede dejar parada indefinidamente una modificación.
+*/
+class Cerrojo
+{
+private:
+      /** @brief Cerrojo de POSIX */
+      pthread_rwlock_t rw;
+
+public:
+      /** @brief Creadora: el cerrojo empieza abierto */
+      Cerrojo()
+      {
+            pthread_rwlockattr_t atributos;
+            pthread_rwlockattr_init(&atributos);
+            pthread_rwlockattr_setkind_np(&atributos, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+            pthread_rwlock_init(&rw, &atributos);
+            pthread_rwlockattr_destroy(&atributos);
+      }
+
+      /** @brief Destructora */
+      ~Cerrojo() { pthread_rwlock_destroy(&rw); }
+
+      /** @brief Cierra el cerrojo, de forma exclusiva si exclusivo es true o compartida si es false (espera si hace falta) */
+      void cerrar(bool exclusivo)
+      {
+            if (exclusivo) pthread_rwlock_wrlock(&rw);
+            else pthread_rwlock_rdlock(&rw);
+      }
+
+      /** @brief Abre el cerrojo que el hilo había cerrado */
+      void abrir() { pthread_rwlock_unlock(&rw); }
+
+private:
+      /** @brief Los objetos no se pueden copiar */
+      Cerrojo(const Cerrojo&);
+      Cerrojo& operator=(const Cerrojo&);
+};
+
+/** @brief Lee y ejecuta las funcionalidades del canal de entrada
+    \pre Evaluator_material y Evaluator_usuarios ya están inicializadas. Si registro no es NULL, tiene un fichero abierto. hilos >= 1. Si cerrojo no es NULL, trabajadores es NULL
+    \post Se han ejecutado todas las funcionalidades del canal de entrada hasta "fin", hasta el final del canal o hasta la primera con un parámetro que no se ha podido leer (que se ha ejecutado con el parámetro a 0 o vacío, como con cin) (los lotes de envíos con como mucho "hilos" hilos). Si trabajadores no es NULL, las funcionalidades fragmentables consecutivas se han ejecutado por tramos con sus hilos (ver ejecutar_tramo), y los contadores de envíos de cada fragmento se han aplicado a Evaluator_material antes de cada funcionalidad que los consulta y al final; la salida es la misma que ejecutándolas una a una. Si registro no es NULL, se ha anotado en él cada funcionalidad modificadora, y las anotaciones se han confirmado antes de vaciar el canal de salida. Si cerrojo no es NULL, cada funcionalidad se ha ejecutado con el cerrojo cerrado (de forma exclusiva si modifica la plataforma)
+*/
+void ejecutar_comandos(Plataforma_material& Evaluator_material, Plataforma_usuarios& Evaluator_usuarios, Registro* registro, int hilos, Trabajadores_tramo* trabajadores, Cerrojo* cerrojo = NULL)
+{
+      int fragmentos = trabajadores == NULL ? 0 : trabajadores->fragmentos();
+      Token t;
+      const char* funcion = NULL;
+      Comando comando = DESCONOCIDO;
+      //los parametros se declaran fuera del bucle para que los strings reaprovechen su memoria de un comando al siguiente
+      string p, s, texto;
+      int c, k;
+      double a, b;
+      vector<Plataforma_usuarios::Envio> lote;
+      vector<string> inscripciones;
+      //por el mismo motivo, las ordenes del tramo no se borran al ejecutarlo: n_tramo indica cuantas son validas
+      vector<Orden> tramo(fragmentos > 0 ? MAX_TRAMO : 1);
+      int n_tramo = 0;
+      vector<Contadores_envios> cambios(fragmentos);
+      while (entrada.leer_token(t) and (comando = identificar_comando(t, funcion)) != FIN) {
+            bool anotar = registro != NULL and es_modificadora(comando);
+            //guardar_estado solo consulta, pero dos a la vez podrian escribir el mismo fichero temporal
+            if (cerrojo != NULL) cerrojo->cerrar(es_modificadora(comando) or comando == GUARDAR_ESTADO);
+            if (anotar) { //copiamos el texto del comando (con todos sus parametros) para anotarlo en el registro
+                  texto = funcion;
+                  entrada.copiar_en(&texto);
             }
-            else if (funcion == "curso_usuario" or funcion == "cu") {
-                  string u;
-                  cin >> u;
-                  cout << "#" << funcion << " " << u << endl;
-                  Evaluator_usuarios.curso_usuario(u);
+            if (es_fragmentable(comando)) {
+                  Orden& o = tramo[n_tramo];
+                  o.comando = comando;
+                  o.funcion = funcion;
+                  leer_orden(o);
+                  if (fragmentos > 0) ++n_tramo;
+                  else ejecutar_orden(o, Evaluator_material, Evaluator_usuarios, NULL);
             }
-            else if (funcion == "sesion_problema" or funcion == "sp") {
-                  int c;
-                  string p;
-                  cin >> c >> p;
-                  cout << "#" << funcion << " " << c << " " << p << endl;
-                  string sesion =  Evaluator_material.sesion_problema(c,p);
-                  if (sesion != "0") cout << sesion << endl;
+            else {
+                  //el resto de funcionalidades pueden depender de todo lo anterior: primero acabamos el tramo pendiente
+                  ejecutar_tramo(tramo, n_tramo, cambios, trabajadores, Evaluator_material, Evaluator_usuarios);
+                  if (consulta_stats(comando)) aplicar_contadores(cambios, Evaluator_material);
+                  long long inicio = medidas_hilo.empezar(comando);
+                  switch (comando) {
+                  case NUEVO_PROBLEMA:
+                        entrada >> p;
+                        salida << "#" << funcion << " " << p << '\n';
+                        Evaluator_material.nuevo_problema(p);
+                        break;
+                  case NUEVA_SESION:
+                        entrada >> s;
+                        salida << "#" << funcion << " " << s << '\n';
+                        Evaluator_material.nueva_sesion(s);
+                        break;
+                  case NUEVO_CURSO:
+                        salida << "#" << funcion << '\n';
+                        Evaluator_material.nuevo_curso();
+                        break;
+                  case ALTA_USUARIO:
+                        entrada >> s;
+                        salida << "#" << funcion << " " << s << '\n';
+                        Evaluator_usuarios.alta_usuario(s);
+                        break;
+                  case BAJA_USUARIO:
+                        entrada >> s;
+                        salida << "#" << funcion << " " << s << '\n';
+                        Evaluator_usuarios.baja_usuario(s, Evaluator_material);
+                        break;
+                  case INSCRIBIR_CURSO:
+                        entrada >> s >> c;
+                        salida << "#" << funcion << " " << s << " " << c << '\n';
+                        Evaluator_usuarios.inscribir_curso(s,c,Evaluator_material);
+                        break;
+                  case LISTAR_PROBLEMAS:
+                        salida << "#" << funcion << '\n';
+                        Evaluator_material.listar_problemas();
+                        break;
+                  case ESCRIBIR_PROBLEMA:
+                        entrada >> p;
+                        salida << "#" << funcion << " " << p << '\n';
+                        Evaluator_material.escribir_problema(p);
+                        break;
+                  case LISTAR_CURSOS:
+                        salida << "#" << funcion << '\n';
+                        Evaluator_material.listar_cursos();
+                        break;
+                  case ESCRIBIR_CURSO:
+                        entrada >> c;
+                        salida << "#" << funcion << " " << c << '\n';
+                        Evaluator_material.escribir_curso(c);
+                        break;
+                  case ESTADISTICAS_CURSO:
+                        entrada >> c;
+                        salida << "#" << funcion << " " << c << '\n';
+                        Evaluator_material.estadisticas_curso(c);
+                        break;
+                  case RANKING_CURSO:
+                        entrada >> c >> k;
+                        salida << "#" << funcion << " " << c << " " << k << '\n';
+                        Evaluator_material.ranking_curso(c, k);
+                        break;
+                  case LISTAR_USUARIOS:
+                        salida << "#" << funcion << '\n';
+                        Evaluator_usuarios.listar_usuarios();
+                        break;
+                  case LISTAR_USUARIOS_PAGINA:
+                        entrada >> s >> k;
+                        salida << "#" << funcion << " " << s << " " << k << '\n';
+                        Evaluator_usuarios.listar_usuarios_pagina(s, k);
+                        break;
+                  case LISTAR_PROBLEMAS_PAGINA:
+                        entrada >> p >> k;
+                        salida << "#" << funcion << " " << p << " " << k << '\n';
+                        Evaluator_material.listar_problemas_pagina(p, k);
+                        break;
+                  case LISTAR_SESIONES_PAGINA:
+                        entrada >> s >> k;
+                        salida << "#" << funcion << " " << s << " " << k << '\n';
+                        Evaluator_material.listar_sesiones_pagina(s, k);
+                        break;
+                  case BUSCAR_USUARIOS:
+                        entrada >> s >> k;
+                        salida << "#" << funcion << " " << s << " " << k << '\n';
+                        Evaluator_usuarios.buscar_usuarios(s, k);
+                        break;
+                  case BUSCAR_PROBLEMAS:
+                        entrada >> p >> s;
+                        salida << "#" << funcion << " " << p << " " << s << '\n';
+                        Evaluator_material.buscar_problemas(p, s);
+                        break;
+                  case PROBLEMAS_FACILES:
+                        entrada >> c;
+                        salida << "#" << funcion << " " << c << '\n';
+                        Evaluator_material.listar_problemas_faciles(c);
+                        break;
+                  case PROBLEMAS_DIFICILES:
+                        entrada >> c;
+                        salida << "#" << funcion << " " << c << '\n';
+                        Evaluator_material.listar_problemas_dificiles(c);
+                        break;
+                  case PROBLEMAS_RATIO:
+                        //los reales se escriben tal y como se han leido (no es modificadora, asi que la copia del canal no se esta usando para el registro)
+                        p.clear();
+                        entrada.copiar_en(&p);
+                        entrada >> a >> b;
+                        entrada.copiar_en(NULL);
+                        salida << "#" << funcion << p << '\n';
+                        Evaluator_material.listar_problemas_ratio(a, b);
+                        break;
+                  case ENVIOS_LOTE:
+                        //cada envio del lote se escribe igual que si fuera una funcionalidad envio, asi la salida es la misma que la de ir haciendo los envios uno a uno
+                        entrada >> c;
+                        salida << "#" << funcion << " " << c << '\n';
+                        lote.resize(c < 0 ? 0 : c);
+                        for (int i = 0; i < lote.size(); ++i) {
+                              entrada >> lote[i].usuario >> lote[i].problema >> lote[i].correcto;
+                              if (entrada.fallo()) lote.resize(i); //el canal se ha acabado (o hay un parametro incorrecto) a media lista: solo se envia lo leido
+                              else salida << "#envio " << lote[i].usuario << " " << lote[i].problema << " " << lote[i].correcto << '\n';
+                        }
+                        Evaluator_usuarios.envios_lote(lote, Evaluator_material, hilos);
+                        break;
+                  case INSCRIBIR_CURSO_LOTE:
+                        //cada usuario del lote se escribe (con su resultado) igual que si fuera una funcionalidad inscribir_curso
+                        entrada >> c >> k;
+                        salida << "#" << funcion << " " << c << " " << k << '\n';
+                        inscripciones.resize(k < 0 ? 0 : k);
+                        for (int i = 0; i < inscripciones.size(); ++i) {
+                              entrada >> inscripciones[i];
+                              if (entrada.fallo()) inscripciones.resize(i);
+                        }
+                        Evaluator_usuarios.inscribir_curso_lote(inscripciones, c, Evaluator_material, hilos);
+                        break;
+                  case GUARDAR_ESTADO: {
+                        entrada >> s;
+                        salida << "#" << funcion << " " << s << '\n';
+                        confirmar_registro(registro); //el estado no puede ir por delante del registro
+                        long long lsn = registro != NULL ? registro->consultar_lsn() : 0;
+                        if (not guardar_estado(s, Evaluator_material, Evaluator_usuarios, lsn)) salida << "error: no se puede guardar el estado" << '\n';
+                        //el estado ya cubre todas las anotaciones: el registro vuelve a empezar, y la recuperacion solo tiene que leer lo que se anote a partir de ahora
+                        //si no se puede cortar, el registro sigue entero (y la recuperacion es igual de correcta, solo mas lenta)
+                        else if (registro != NULL) registro->cortar(lsn);
+                        break;
+                  }
+                  case ESTADISTICAS:
+                        salida << "#" << funcion << '\n';
+                        escribir_estadisticas();
+                        break;
+                  default: //las palabras que no son ninguna funcionalidad se ignoran
+                        break;
+                  }
+                  medidas_hilo.acabar(comando, inicio);
             }
-            else if (funcion == "problemas_resueltos" or funcion == "pr") {
-                  string u;
-                  cin >> u;
-                  cout << "#" << funcion << " " << u << endl;
-                  Evaluator_usuarios.problemas_resueltos(u);
+            if (anotar) {
+                  entrada.copiar_en(NULL);
+                  if (not registro->anotar(texto)) confirmar_registro(registro); //si la confirmacion automatica ha fallado, la repetimos (y si vuelve a fallar, acabamos)
             }
-            else if (funcion == "problemas_enviables" or funcion == "pe") {
-                  string u;
-                  cin >> u;
-                  cout << "#" << funcion << " " << u << endl;
-                  Evaluator_usuarios.problemas_enviables(u);
+            if (cerrojo != NULL) cerrojo->abrir();
+            if (n_tramo == MAX_TRAMO) ejecutar_tramo(tramo, n_tramo, cambios, trabajadores, Evaluator_material, Evaluator_usuarios);
+            //si ya hemos tratado todo lo que habia llegado por el canal de entrada, confirmamos el registro y vaciamos la salida antes de esperar el siguiente bloque
+            if (not entrada.pendiente()) {
+                  ejecutar_tramo(tramo, n_tramo, cambios, trabajadores, Evaluator_material, Evaluator_usuarios);
+                  confirmar_registro(registro);
+                  salida.vaciar();
             }
+            //igual que con cin, un parametro que no se ha podido leer (final del canal o numero incorrecto) acaba la lectura
+            if (entrada.fallo()) break;
+      }
+      ejecutar_tramo(tramo, n_tramo, cambios, trabajadores, Evaluator_material, Evaluator_usuarios);
+      aplicar_contadores(cambios, Evaluator_material);
+}
 
-            else if (funcion == "envio" or funcion == "e") {
-                  string u, p;
-                  bool r;
-                  cin >> u >> p >> r;
-                  cout << "#" << funcion << " " << u << " " << p << " " << r << endl;
-                  Evaluator_usuarios.envio(u,p,r,Evaluator_material);
-            }
+/** @brief Responde a lo que ha enviado un cliente del modo servidor antes de esperar a que envíe más
+    \pre registro es NULL o un Registro con un fichero abierto
+    \post Se han confirmado las anotaciones pendientes del registro (si no es NULL) y se ha vaciado el canal de salida del hilo
+*/
+void responder(void* registro)
+{
+      confirmar_registro((Registro*)registro);
+      salida.vaciar();
+}
 
-            else if (funcion == "listar_problemas" or funcion == "lp") {
-                  cout << "#" << funcion << endl;
-                  Evaluator_material.listar_problemas();
-            }
-            else if (funcion == "escribir_problema" or funcion == "ep") {
-                  string p;
-                  cin >> p;
-                  cout << "#" << funcion << " " << p << endl;
-                  Evaluator_material.escribir_problema(p);
-            }
-            else if (funcion == "listar_sesiones" or funcion == "ls") {
-                  cout << "#" << funcion << endl;
-                  Evaluator_material.listar_sesiones();
-                }
-            else if (funcion == "escribir_sesion" or funcion == "es") {
-                  string s;
-                  cin >> s;
-                  cout << "#" << funcion << " " << s << endl;
-                  Evaluator_material.escribir_sesion(s);
-            }
-            else if (funcion == "listar_cursos" or funcion == "lc") {
-                  cout << "#" << funcion << endl;
-                  Evaluator_material.listar_cursos();
+/** @brief Atiende una conexión del modo servidor
+    \pre fd es un socket conectado con un cliente. pm y pu son la plataforma compartida por todas las conexiones, protegida por cerrojo. Si registro no es NULL, tiene un fichero abierto
+    \post Se han ejecutado las funcionalidades que ha enviado el cliente (hasta "fin" o hasta que ha cerrado la conexión), y se le ha respondido por el mismo socket. La respuesta a cada bloque de funcionalidades se envía antes de esperar el siguiente bloque (ver responder), aunque el bloque acabe en medio de una funcionalidad. Se ha cerrado el socket
+*/
+void atender_conexion(int fd, Plataforma_material* pm, Plataforma_usuarios* pu, Registro* registro, int hilos, Cerrojo* cerrojo)
+{
+      FILE* de_cliente = fdopen(fd, "r");
+      FILE* a_cliente = fdopen(dup(fd), "w");
+      if (de_cliente == NULL or a_cliente == NULL) {
+            if (de_cliente != NULL) fclose(de_cliente);
+            else close(fd);
+            if (a_cliente != NULL) fclose(a_cliente);
+            return;
+      }
+      {
+            //los canales de este hilo pasan a ser los de la conexion
+            Lector lector(de_cliente, 1 << 16);
+            lector.al_esperar(responder, registro);
+            Escritor escritor(a_cliente);
+            entrada.intercambiar(lector);
+            salida.intercambiar(escritor);
+            ejecutar_comandos(*pm, *pu, registro, hilos, NULL, cerrojo);
+            confirmar_registro(registro);
+            salida.vaciar();
+            entrada.intercambiar(lector);
+            salida.intercambiar(escritor);
+      }
+      fclose(de_cliente);
+      fclose(a_cliente);
+}
+
+/** @brief Modo servidor: atiende conexiones por un socket local
+    \pre pm y pu ya están inicializadas. Si registro no es NULL, tiene un fichero abierto
+    \post Si no se puede crear el socket "ruta", retorna false. Si se puede, no retorna nunca: acepta conexiones y atiende cada una en un hilo propio (con atender_conexion), todas sobre la misma plataforma
+*/
+bool servir(const string& ruta, Plataforma_material& pm, Plataforma_usuarios& pu, Registro* registro, int hilos)
+{
+      sockaddr_un direccion;
+      memset(&direccion, 0, sizeof(direccion));
+      direccion.sun_family = AF_UNIX;
+      if (ruta.size() >= sizeof(direccion.sun_path)) return false;
+      strcpy(direccion.sun_path, ruta.c_str());
+      int escucha = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (escucha == -1) return false;
+      unlink(ruta.c_str()); //un socket que haya quedado de una ejecucion anterior
+      if (bind(escucha, (sockaddr*)&direccion, sizeof(direccion)) != 0 or listen(escucha, SOMAXCONN) != 0) {
+            close(escucha);
+            return false;
+      }
+      signal(SIGPIPE, SIG_IGN); //si un cliente cierra la conexion antes de leer la respuesta, write falla en lugar de acabar el programa
+      salida.vaciar();
+      static Cerrojo cerrojo;
+      while (true) {
+            int fd = accept(escucha, NULL, NULL);
+            if (fd != -1) thread(atender_conexion, fd, &pm, &pu, registro, hilos, &cerrojo).detach();
+      }
+}
+
+/** @brief Mediante este programa se podrá realizar por un lado la inicialización del Evaluator y, por otro, las funcionalidades que ofrece la plataforma Evaluator
+
+    La inicialización se lee del canal de entrada, o bien (con la opción "--estado fichero") de un fichero de estado escrito por la funcionalidad guardar_estado.
+
+    Con la opción "--registro fichero", las funcionalidades modificadoras se anotan en un registro de escritura anticipada. Si el fichero ya contenía anotaciones posteriores al estado inicial (por ejemplo, porque el programa se interrumpió), primero se vuelven a ejecutar (sin escribir nada en el canal de salida). La opción "--lote n" indica cada cuántas anotaciones se sincroniza el registro con el disco (además de cada vez que se vacía el canal de salida); con n = 0 no se sincroniza nunca. Cada vez que guardar_estado guarda el estado, el registro vuelve a empezar vacío (ver Registro::cortar): a partir de entonces, para recuperar la plataforma hay que arrancar con ese estado ("--estado fichero") y el mismo registro.
+
+    La opción "--hilos n" indica cuántos hilos se pueden utilizar para aplicar los lotes de envíos (por defecto, tantos como procesadores).
+
+    Con la opción "--servidor ruta", una vez inicializada la plataforma (y recuperado el registro), el programa no lee las funcionalidades del canal de entrada sino de las conexiones que recibe por el socket local "ruta". Cada conexión envía las mismas funcionalidades que se escribirían en el canal de entrada y recibe las respuestas por la misma conexión; las conexiones se atienden a la vez (ver Cerrojo y atender_conexion).
+
+    Con la opción "--fragmentos n" (n > 0), los usuarios se reparten en n fragmentos, cada uno tratado por un hilo que se crea al empezar (ver Trabajadores_tramo), y las funcionalidades que solo afectan a un usuario o solo consultan sesiones se ejecutan en paralelo por tramos (ver ejecutar_tramo). La salida es la misma que sin la opción.
+
+    El programa cuenta cuántas veces se ejecuta cada funcionalidad y mide la latencia de una de cada n ejecuciones (n = 8, o el valor de la opción "--muestreo n"). La funcionalidad estadisticas escribe las medidas (ver escribir_estadisticas), y con la opción "--estadisticas" también se escriben en el canal de error al acabar.
+*/
+
+int main(int argc, char* argv[])
+{
+      //inicializamos la Plataforma Evaluator
+      Plataforma_material Evaluator_material;
+      Plataforma_usuarios Evaluator_usuarios;
+
+      string fichero_estado, fichero_registro, ruta_servidor;
+      int lote = 1024;
+      int hilos = thread::hardware_concurrency();
+      int fragmentos = 0;
+      bool mostrar_estadisticas = false;
+      for (int i = 1; i < argc; ++i) {
+            if (strcmp(argv[i], "--estado") == 0 and i + 1 < argc) fichero_estado = argv[++i];
+            else if (strcmp(argv[i], "--registro") == 0 and i + 1 < argc) fichero_registro = argv[++i];
+            else if (strcmp(argv[i], "--lote") == 0 and i + 1 < argc) lote = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--hilos") == 0 and i + 1 < argc) hilos = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--fragmentos") == 0 and i + 1 < argc) fragmentos = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--servidor") == 0 and i + 1 < argc) ruta_servidor = argv[++i];
+            else if (strcmp(argv[i], "--muestreo") == 0 and i + 1 < argc) muestreo = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--estadisticas") == 0) mostrar_estadisticas = true;
+            else {
+                  fprintf(stderr, "uso: %s [--estado fichero] [--registro fichero [--lote n]] [--hilos n] [--fragmentos n] [--servidor ruta] [--muestreo n] [--estadisticas]\n", argv[0]);
+                  return 1;
             }
-            else if (funcion == "escribir_curso" or funcion == "ec") {
-                  int c;
-                  cin >> c;
-                  cout << "#" << funcion << " " << c << endl;
-                  Evaluator_material.escribir_curso(c);
+      }
+
+      if (hilos < 1) hilos = 1;
+      if (fragmentos < 0) fragmentos = 0;
+      if (muestreo < 1) muestreo = 1;
+
+      long long lsn = 0;
+      if (not fichero_estado.empty()) {
+            //cargamos la plataforma del fichero de estado
+            if (not cargar_estado(fichero_estado, Evaluator_material, Evaluator_usuarios, lsn)) {
+                  fprintf(stderr, "error: no se puede cargar el estado de %s\n", fichero_estado.c_str());
+                  return 1;
             }
-            else if (funcion == "listar_usuarios" or funcion == "lu") {
-                  cout << "#" << funcion << endl;
-                  Evaluator_usuarios.listar_usuarios();
+      }
+      else {
+            //leemos los problemas para la inicializacion
+            Evaluator_material.leer_cj_problemas();
+
+            //leemos las sesiones para la inicializacion
+            Evaluator_material.leer_cj_sesiones();
+
+            //leemos los cursos para la inicializacion
+            Evaluator_material.leer_cj_cursos();
+
+            //leemos los usuarios para la inicializacion
+            Evaluator_usuarios.leer_cj_usuarios();
+      }
+      inicializar_comandos();
+
+      Registro registro(lote < 0 ? 0 : lote);
+      if (not fichero_registro.empty()) {
+            vector<string> pendientes;
+            if (not registro.abrir(fichero_registro, lsn, pendientes)) {
+                  fprintf(stderr, "error: no se puede abrir el registro %s\n", fichero_registro.c_str());
+                  return 1;
             }
-            else if (funcion == "escribir_usuario" or funcion == "eu") {
-                  string u;
-                  cin >> u;
-                  cout << "#" << funcion << " " << u << endl;
-                  Evaluator_usuarios.escribir_usuario(u);
+            //volvemos a ejecutar, sin escribir nada, las anotaciones posteriores al estado inicial
+            salida.silenciar(true);
+            for (int i = 0; i < pendientes.size(); ++i) {
+                  Lector comando(pendientes[i]);
+                  entrada.intercambiar(comando);
+                  ejecutar_comandos(Evaluator_material, Evaluator_usuarios, NULL, hilos, NULL);
+                  entrada.intercambiar(comando);
             }
+            salida.silenciar(false);
+      }
+
+      if (not ruta_servidor.empty()) {
+            servir(ruta_servidor, Evaluator_material, Evaluator_usuarios, fichero_registro.empty() ? NULL : &registro, hilos);
+            fprintf(stderr, "error: no se puede escuchar en %s\n", ruta_servidor.c_str());
+            return 1;
+      }
+
+      //ya tenemos la plataforma inicializada. A continuación leemos y executamos las funcionalidades
+      Trabajadores_tramo trabajadores(fragmentos, Evaluator_material, Evaluator_usuarios);
+      ejecutar_comandos(Evaluator_material, Evaluator_usuarios, fichero_registro.empty() ? NULL : &registro, hilos, fragmentos > 0 ? &trabajadores : NULL);
+      confirmar_registro(&registro);
+      salida.vaciar();
+      if (mostrar_estadisticas) {
+            Escritor error(stderr);
+            salida.intercambiar(error);
+            escribir_estadisticas();
+            salida.vaciar();
+            salida.intercambiar(error);
       }
 }
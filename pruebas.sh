@@ -0,0 +1,74 @@
+#!/bin/sh
+# Pruebas de principio a fin (make test).
+# Cada fichero pruebas/X.inp es una entrada completa de program.exe (inicializacion y funcionalidades) y pruebas/X.cor la
+# salida que tiene que producir. Si existe pruebas/X.opc, contiene las opciones con las que se ejecuta program.exe.
+# Si existe pruebas/X.ant, antes se ejecuta program.exe con esa entrada (y las opciones de pruebas/X.opa, si existe) en el
+# mismo directorio, sin comprobar su salida: asi se preparan los ficheros de estado o de registro que lee la prueba.
+# Despues se comprueba que la respuesta a cada bloque de funcionalidades llega sin esperar a que se cierre el canal de entrada,
+# tanto por una tuberia como por una conexion del modo servidor (con cliente.exe).
+
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+fallos=0
+
+# escribe "ok" o "FALLO" para la prueba $1 segun el resultado de la ultima orden
+resultado() {
+    if [ $? -eq 0 ]; then echo "$1: ok"; else echo "$1: FALLO"; fallos=$((fallos + 1)); fi
+}
+
+for entrada in pruebas/*.inp; do
+    [ -f "$entrada" ] || continue
+    nombre=$(basename "$entrada" .inp)
+    if [ -f "pruebas/$nombre.ant" ]; then
+        opciones=""
+        if [ -f "pruebas/$nombre.opa" ]; then opciones=$(cat "pruebas/$nombre.opa"); fi
+        (cd "$DIR" && "$OLDPWD/program.exe" $opciones) < "pruebas/$nombre.ant" > /dev/null 2>&1
+    fi
+    opciones=""
+    if [ -f "pruebas/$nombre.opc" ]; then opciones=$(cat "pruebas/$nombre.opc"); fi
+    (cd "$DIR" && "$OLDPWD/program.exe" $opciones) < "$entrada" > "$DIR/$nombre.out" 2>&1
+    diff "$DIR/$nombre.out" "pruebas/$nombre.cor" > "$DIR/$nombre.dif"
+    resultado "$nombre"
+    if [ -s "$DIR/$nombre.dif" ]; then head -20 "$DIR/$nombre.dif"; fi
+done
+
+# espera (como mucho $2 decimas de segundo) a que el fichero $1 contenga la linea $3
+esperar_linea() {
+    i=0
+    while [ $i -lt $2 ]; do
+        if grep -qx -- "$3" "$1"; then return 0; fi
+        sleep 0.1
+        i=$((i + 1))
+    done
+    return 1
+}
+
+INICIAL="1 p1 1 s1 p1 0 0 1 1 s1 1 u1"
+
+# tuberia que sigue abierta: la respuesta a escribir_usuario tiene que llegar antes de escribir nada mas
+mkfifo "$DIR/tuberia"
+./program.exe < "$DIR/tuberia" > "$DIR/tuberia.out" &
+programa=$!
+exec 3> "$DIR/tuberia"
+echo "$INICIAL" >&3
+echo "escribir_usuario u1" >&3
+esperar_linea "$DIR/tuberia.out" 20 "u1(0,0,0,0)"
+resultado "tuberia abierta"
+echo "fin" >&3
+exec 3>&-
+wait $programa
+
+# servidor: cada linea que envia el cliente por la misma conexion tiene que recibir su respuesta, aunque acabe en medio de una
+# funcionalidad (la segunda linea deja escribir_usuario sin parametro, que llega con la tercera)
+echo "$INICIAL" | ./program.exe --servidor "$DIR/socket" &
+servidor=$!
+esperar_socket=0
+while [ ! -S "$DIR/socket" ] && [ $esperar_socket -lt 20 ]; do sleep 0.1; esperar_socket=$((esperar_socket + 1)); done
+printf 'escribir_usuario u1\nalta_usuario u2 escribir_usuario\nu2\nlistar_usuarios\n' | ./cliente.exe "$DIR/socket" 2000 > "$DIR/servidor.out"
+printf '#escribir_usuario u1\nu1(0,0,0,0)\n#alta_usuario u2\n2\n#escribir_usuario u2\nu2(0,0,0,0)\n#listar_usuarios\nu1(0,0,0,0)\nu2(0,0,0,0)\n' | diff "$DIR/servidor.out" -
+resultado "servidor"
+kill $servidor
+wait $servidor 2> /dev/null
+
+if [ $fallos -gt 0 ]; then echo "$fallos pruebas fallidas"; exit 1; fi
+echo "todas las pruebas correctas"